@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include <codeslayer/codeslayer.h>
+
+static void codeslayer_class_init          (CodeSlayerClass        *klass);
+static void codeslayer_init                (CodeSlayer             *codeslayer);
+static void codeslayer_finalize            (CodeSlayer             *codeslayer);
+static void codeslayer_project_class_init  (CodeSlayerProjectClass *klass);
+static void codeslayer_project_init        (CodeSlayerProject      *project);
+static void codeslayer_project_finalize    (CodeSlayerProject      *project);
+
+#define CODESLAYER_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CODESLAYER_TYPE, CodeSlayerPrivate))
+
+#define CODESLAYER_PROJECT_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CODESLAYER_PROJECT_TYPE, CodeSlayerProjectPrivate))
+
+typedef struct _CodeSlayerPrivate CodeSlayerPrivate;
+
+struct _CodeSlayerPrivate
+{
+  gchar         *config_folder_path;
+  GList         *projects;
+  GList         *widgets;
+  GList         *editors;
+  GtkAccelGroup *accel_group;
+  guint          select_count;
+};
+
+typedef struct _CodeSlayerProjectPrivate CodeSlayerProjectPrivate;
+
+struct _CodeSlayerProjectPrivate
+{
+  gchar *name;
+  gchar *folder_path;
+};
+
+enum
+{
+  PATH_NAVIGATED,
+  PROJECTS_CHANGED,
+  EDITOR_ADDED,
+  LAST_SIGNAL
+};
+
+static guint codeslayer_signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (CodeSlayer, codeslayer, G_TYPE_OBJECT)
+G_DEFINE_TYPE (CodeSlayerProject, codeslayer_project, G_TYPE_OBJECT)
+
+static void
+codeslayer_class_init (CodeSlayerClass *klass)
+{
+  codeslayer_signals[PATH_NAVIGATED] =
+    g_signal_new ("path-navigated", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL, NULL, 
+                  G_TYPE_NONE, 4, G_TYPE_STRING, G_TYPE_INT, G_TYPE_STRING, G_TYPE_INT);
+
+  codeslayer_signals[PROJECTS_CHANGED] =
+    g_signal_new ("projects-changed", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL, 
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+  codeslayer_signals[EDITOR_ADDED] =
+    g_signal_new ("editor-added", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  0, NULL, NULL, 
+                  g_cclosure_marshal_VOID__OBJECT, G_TYPE_NONE, 1, G_TYPE_OBJECT);
+
+  G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) codeslayer_finalize;
+  g_type_class_add_private (klass, sizeof (CodeSlayerPrivate));
+}
+
+static void
+codeslayer_init (CodeSlayer *codeslayer)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  priv->config_folder_path = NULL;
+  priv->projects = NULL;
+  priv->widgets = NULL;
+  priv->editors = NULL;
+  priv->accel_group = NULL;
+  priv->select_count = 0;
+}
+
+static void
+codeslayer_finalize (CodeSlayer *codeslayer)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  
+  g_free (priv->config_folder_path);
+  g_list_free_full (priv->projects, g_object_unref);
+  g_list_free_full (priv->widgets, g_object_unref);
+  g_list_free_full (priv->editors, g_object_unref);
+  
+  if (priv->accel_group != NULL)
+    g_object_unref (priv->accel_group);
+
+  G_OBJECT_CLASS (codeslayer_parent_class)->finalize (G_OBJECT (codeslayer));
+}
+
+CodeSlayer*
+codeslayer_stub_new (const gchar *config_folder_path)
+{
+  CodeSlayerPrivate *priv;
+  CodeSlayer *codeslayer;
+
+  codeslayer = CODESLAYER (g_object_new (codeslayer_get_type (), NULL));
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  priv->config_folder_path = g_strdup (config_folder_path);
+
+  return codeslayer;
+}
+
+void
+codeslayer_stub_add_project (CodeSlayer  *codeslayer,
+                             const gchar *name,
+                             const gchar *folder_path)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  priv->projects = g_list_append (priv->projects, codeslayer_project_new (name, folder_path));
+  g_signal_emit (codeslayer, codeslayer_signals[PROJECTS_CHANGED], 0);
+}
+
+guint
+codeslayer_stub_get_select_count (CodeSlayer *codeslayer)
+{
+  return CODESLAYER_GET_PRIVATE (codeslayer)->select_count;
+}
+
+CodeSlayerEditor*
+codeslayer_stub_open_editor (CodeSlayer  *codeslayer,
+                             const gchar *file_path)
+{
+  CodeSlayerPrivate *priv;
+  GtkWidget *editor;
+  
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+
+  editor = gtk_text_view_new ();
+  g_object_set_data_full (G_OBJECT (editor), "file_path", g_strdup (file_path), g_free);
+  priv->editors = g_list_append (priv->editors, g_object_ref_sink (editor));
+  
+  g_signal_emit (codeslayer, codeslayer_signals[EDITOR_ADDED], 0, editor);
+  
+  return CODESLAYER_EDITOR (editor);
+}
+
+void
+codeslayer_stub_close_editor (CodeSlayer       *codeslayer,
+                              CodeSlayerEditor *editor)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  priv->editors = g_list_remove (priv->editors, editor);
+  gtk_widget_destroy (GTK_WIDGET (editor));
+  g_object_unref (editor);
+}
+
+GList*
+codeslayer_get_all_editors (CodeSlayer *codeslayer)
+{
+  return g_list_copy (CODESLAYER_GET_PRIVATE (codeslayer)->editors);
+}
+
+CodeSlayerDocument*
+codeslayer_editor_get_document (CodeSlayerEditor *editor)
+{
+  return (CodeSlayerDocument *) editor;
+}
+
+const gchar*
+codeslayer_document_get_file_path (CodeSlayerDocument *document)
+{
+  return g_object_get_data (G_OBJECT (document), "file_path");
+}
+
+gboolean
+codeslayer_select_document_by_file_path (CodeSlayer  *codeslayer, 
+                                         const gchar *file_path, 
+                                         gint         line_number)
+{
+  CODESLAYER_GET_PRIVATE (codeslayer)->select_count++;
+  return TRUE;
+}
+
+CodeSlayerProject*
+codeslayer_get_project_by_file_path (CodeSlayer  *codeslayer, 
+                                     const gchar *file_path)
+{
+  CodeSlayerPrivate *priv;
+  GList *list;
+  
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+
+  for (list = priv->projects; list != NULL; list = list->next)
+    {
+      CodeSlayerProject *project = list->data;
+      const gchar *folder_path = codeslayer_project_get_folder_path (project);
+      if (g_str_has_prefix (file_path, folder_path) && 
+          file_path[strlen (folder_path)] == G_DIR_SEPARATOR)
+        return project;
+    }
+
+  return NULL;
+}
+
+gchar*
+codeslayer_get_plugins_config_folder_path (CodeSlayer *codeslayer)
+{
+  return g_strdup (CODESLAYER_GET_PRIVATE (codeslayer)->config_folder_path);
+}
+
+GtkWindow*
+codeslayer_get_toplevel_window (CodeSlayer *codeslayer)
+{
+  return NULL;
+}
+
+GtkAccelGroup*
+codeslayer_get_menu_bar_accel_group (CodeSlayer *codeslayer)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  
+  if (priv->accel_group == NULL)
+    priv->accel_group = gtk_accel_group_new ();
+  
+  return priv->accel_group;
+}
+
+static void
+hold_widget (CodeSlayer *codeslayer,
+             GtkWidget  *widget)
+{
+  CodeSlayerPrivate *priv;
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  priv->widgets = g_list_prepend (priv->widgets, g_object_ref_sink (widget));
+}
+
+static void
+release_widget (CodeSlayer *codeslayer,
+                GtkWidget  *widget)
+{
+  CodeSlayerPrivate *priv;
+  GList *link;
+  
+  priv = CODESLAYER_GET_PRIVATE (codeslayer);
+  
+  link = g_list_find (priv->widgets, widget);
+  if (link == NULL)
+    return;
+  
+  priv->widgets = g_list_delete_link (priv->widgets, link);
+  gtk_widget_destroy (widget);
+  g_object_unref (widget);
+}
+
+void
+codeslayer_add_to_menu_bar (CodeSlayer  *codeslayer, 
+                            GtkMenuItem *menuitem)
+{
+  hold_widget (codeslayer, GTK_WIDGET (menuitem));
+}
+
+void
+codeslayer_remove_from_menu_bar (CodeSlayer  *codeslayer, 
+                                 GtkMenuItem *menuitem)
+{
+  release_widget (codeslayer, GTK_WIDGET (menuitem));
+}
+
+void
+codeslayer_add_to_side_pane (CodeSlayer  *codeslayer, 
+                             GtkWidget   *widget, 
+                             const gchar *label)
+{
+  GtkWidget *window;
+  
+  /* shown, as the pane only builds its widgets once it is mapped */
+  window = gtk_offscreen_window_new ();
+  gtk_container_add (GTK_CONTAINER (window), widget);
+  gtk_widget_show_all (window);
+  
+  hold_widget (codeslayer, window);
+}
+
+void
+codeslayer_remove_from_side_pane (CodeSlayer *codeslayer, 
+                                  GtkWidget  *widget)
+{
+  release_widget (codeslayer, gtk_widget_get_toplevel (widget));
+}
+
+GtkWidget*
+codeslayer_menu_item_new_with_label (const gchar *label)
+{
+  return gtk_menu_item_new_with_label (label);
+}
+
+gchar*
+codeslayer_utils_get_file_path (const gchar *folder_path, 
+                                const gchar *file_name)
+{
+  return g_build_filename (folder_path, file_name, NULL);
+}
+
+GKeyFile*
+codeslayer_utils_get_key_file (const gchar *file_path)
+{
+  GKeyFile *key_file;
+  key_file = g_key_file_new ();
+  g_key_file_load_from_file (key_file, file_path, G_KEY_FILE_NONE, NULL);
+  return key_file;
+}
+
+void
+codeslayer_utils_save_key_file (GKeyFile    *key_file, 
+                                const gchar *file_path)
+{
+  gchar *data;
+  gsize length;
+  
+  data = g_key_file_to_data (key_file, &length, NULL);
+  g_file_set_contents (file_path, data, length, NULL);
+  g_free (data);
+}
+
+static void
+codeslayer_project_class_init (CodeSlayerProjectClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) codeslayer_project_finalize;
+  g_type_class_add_private (klass, sizeof (CodeSlayerProjectPrivate));
+}
+
+static void
+codeslayer_project_init (CodeSlayerProject *project)
+{
+  CodeSlayerProjectPrivate *priv;
+  priv = CODESLAYER_PROJECT_GET_PRIVATE (project);
+  priv->name = NULL;
+  priv->folder_path = NULL;
+}
+
+static void
+codeslayer_project_finalize (CodeSlayerProject *project)
+{
+  CodeSlayerProjectPrivate *priv;
+  priv = CODESLAYER_PROJECT_GET_PRIVATE (project);
+  g_free (priv->name);
+  g_free (priv->folder_path);
+  G_OBJECT_CLASS (codeslayer_project_parent_class)->finalize (G_OBJECT (project));
+}
+
+CodeSlayerProject*
+codeslayer_project_new (const gchar *name,
+                        const gchar *folder_path)
+{
+  CodeSlayerProjectPrivate *priv;
+  CodeSlayerProject *project;
+
+  project = CODESLAYER_PROJECT (g_object_new (codeslayer_project_get_type (), NULL));
+  priv = CODESLAYER_PROJECT_GET_PRIVATE (project);
+  priv->name = g_strdup (name);
+  priv->folder_path = g_strdup (folder_path);
+
+  return project;
+}
+
+const gchar*
+codeslayer_project_get_name (CodeSlayerProject *project)
+{
+  return CODESLAYER_PROJECT_GET_PRIVATE (project)->name;
+}
+
+const gchar*
+codeslayer_project_get_folder_path (CodeSlayerProject *project)
+{
+  return CODESLAYER_PROJECT_GET_PRIVATE (project)->folder_path;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __CODESLAYER_H__
+#define __CODESLAYER_H__
+
+#include <gtk/gtk.h>
+#include <codeslayer/codeslayer-project.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A stand-in for the parts of the CodeSlayer API the plugin uses, so the
+ * engine can be driven outside of a running editor. Only the benchmarks are
+ * built against it.
+ */
+
+#ifndef _
+#define _(String) (String)
+#endif
+
+#define CODESLAYER_TYPE            (codeslayer_get_type ())
+#define CODESLAYER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CODESLAYER_TYPE, CodeSlayer))
+#define CODESLAYER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CODESLAYER_TYPE, CodeSlayerClass))
+#define IS_CODESLAYER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CODESLAYER_TYPE))
+#define IS_CODESLAYER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CODESLAYER_TYPE))
+
+#define CODESLAYER_EDITOR(obj)     ((CodeSlayerEditor *) (obj))
+
+typedef struct _CodeSlayer CodeSlayer;
+typedef struct _CodeSlayerClass CodeSlayerClass;
+
+/* editors are plain text views here, and stand in for their documents too */
+typedef struct _CodeSlayerEditor CodeSlayerEditor;
+typedef struct _CodeSlayerDocument CodeSlayerDocument;
+
+struct _CodeSlayer
+{
+  GObject parent_instance;
+};
+
+struct _CodeSlayerClass
+{
+  GObjectClass parent_class;
+};
+
+GType codeslayer_get_type (void) G_GNUC_CONST;
+
+CodeSlayer*         codeslayer_stub_new                        (const gchar  *config_folder_path);
+void                codeslayer_stub_add_project                (CodeSlayer   *codeslayer,
+                                                                const gchar  *name,
+                                                                const gchar  *folder_path);
+guint               codeslayer_stub_get_select_count           (CodeSlayer   *codeslayer);
+CodeSlayerEditor*   codeslayer_stub_open_editor                (CodeSlayer   *codeslayer,
+                                                                const gchar  *file_path);
+void                codeslayer_stub_close_editor               (CodeSlayer   *codeslayer,
+                                                                CodeSlayerEditor *editor);
+
+gboolean            codeslayer_select_document_by_file_path    (CodeSlayer   *codeslayer, 
+                                                                const gchar  *file_path, 
+                                                                gint          line_number);
+CodeSlayerProject*  codeslayer_get_project_by_file_path        (CodeSlayer   *codeslayer, 
+                                                                const gchar  *file_path);
+gchar*              codeslayer_get_plugins_config_folder_path  (CodeSlayer   *codeslayer);
+GList*              codeslayer_get_all_editors                 (CodeSlayer   *codeslayer);
+CodeSlayerDocument* codeslayer_editor_get_document             (CodeSlayerEditor *editor);
+const gchar*        codeslayer_document_get_file_path          (CodeSlayerDocument *document);
+GtkWindow*          codeslayer_get_toplevel_window             (CodeSlayer   *codeslayer);
+GtkAccelGroup*      codeslayer_get_menu_bar_accel_group        (CodeSlayer   *codeslayer);
+void                codeslayer_add_to_menu_bar                 (CodeSlayer   *codeslayer, 
+                                                                GtkMenuItem  *menuitem);
+void                codeslayer_remove_from_menu_bar            (CodeSlayer   *codeslayer, 
+                                                                GtkMenuItem  *menuitem);
+void                codeslayer_add_to_side_pane                (CodeSlayer   *codeslayer, 
+                                                                GtkWidget    *widget, 
+                                                                const gchar  *label);
+void                codeslayer_remove_from_side_pane           (CodeSlayer   *codeslayer, 
+                                                                GtkWidget    *widget);
+
+GtkWidget*          codeslayer_menu_item_new_with_label        (const gchar  *label);
+
+gchar*              codeslayer_utils_get_file_path             (const gchar  *folder_path, 
+                                                                const gchar  *file_name);
+GKeyFile*           codeslayer_utils_get_key_file              (const gchar  *file_path);
+void                codeslayer_utils_save_key_file             (GKeyFile     *key_file, 
+                                                                const gchar  *file_path);
+
+G_END_DECLS
+
+#endif /* __CODESLAYER_H__ */
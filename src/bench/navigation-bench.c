@@ -0,0 +1,783 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <glib/gstdio.h>
+#include <codeslayer/codeslayer.h>
+#include "navigation-engine.h"
+#include "navigation-menu.h"
+#include "navigation-pane.h"
+#include "navigation-model.h"
+#include "navigation-history.h"
+#include "navigation-journal.h"
+#include "navigation-hotspots.h"
+#include "navigation-path.h"
+
+/*
+ * Drives the history, model, journal, pane and engine with synthetic
+ * navigation at a range of history sizes and reports the cost per operation.
+ * Run it with "make bench", passing options through BENCH_FLAGS.
+ */
+
+#define DRAIN_INTERVAL 64
+#define PUSH_THREADS 4
+#define PUSH_FILE "/bench/push/thread"
+#define PUSH_DONE "/bench/push/done.c"
+#define PUSH_TIMEOUT (10 * G_USEC_PER_SEC)
+
+typedef struct
+{
+  guint file;
+  gint  line_number;
+} Jump;
+
+typedef struct
+{
+  NavigationEngine *engine;
+  guint             thread;
+  gint              count;
+} Pusher;
+
+typedef struct
+{
+  gint     last[PUSH_THREADS];
+  gboolean ordered;
+  gboolean done;
+} PushCheck;
+
+typedef struct
+{
+  const gchar *name;
+  guint        capacity;
+  guint        operations;
+  gint64       start;
+  gint         allocations;
+} Measure;
+
+static gchar *capacities = "25,1000,10000";
+static gint operations = 100000;
+static gint file_count = 500;
+
+static GOptionEntry entries[] =
+{
+  { "capacities", 'c', 0, G_OPTION_ARG_STRING, &capacities, "History sizes to run at", "N,N,..." },
+  { "operations", 'n', 0, G_OPTION_ARG_INT, &operations, "Operations per benchmark", "N" },
+  { "files", 'f', 0, G_OPTION_ARG_INT, &file_count, "Distinct files to navigate between", "N" },
+  { NULL }
+};
+
+static gchar **file_paths;
+static Jump *jumps;
+static gboolean failed = FALSE;
+
+/* 
+ * Every allocation made through malloc is counted by interposing the libc
+ * allocator. GSlice is pointed at malloc too so that it is counted as well.
+ */
+static volatile gint allocations = 0;
+
+#ifdef __GLIBC__
+#define COUNTS_ALLOCATIONS TRUE
+
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t count, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+void*
+malloc (size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_malloc (size);
+}
+
+void*
+calloc (size_t count, 
+        size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_calloc (count, size);
+}
+
+void*
+realloc (void   *ptr, 
+         size_t  size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_realloc (ptr, size);
+}
+#else
+#define COUNTS_ALLOCATIONS FALSE
+#endif
+
+static glong
+get_peak_rss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static void
+measure_begin (Measure     *measure,
+               const gchar *name,
+               guint        capacity,
+               guint        operations)
+{
+  measure->name = name;
+  measure->capacity = capacity;
+  measure->operations = MAX (1, operations);
+  measure->allocations = g_atomic_int_get (&allocations);
+  measure->start = g_get_monotonic_time ();
+}
+
+static void
+measure_end (Measure *measure)
+{
+  gint64 elapsed;
+  gint allocated;
+  
+  elapsed = g_get_monotonic_time () - measure->start;
+  allocated = g_atomic_int_get (&allocations) - measure->allocations;
+
+  g_print ("%-14s %9u %9u %12.1f", measure->name, measure->capacity, 
+           measure->operations, elapsed * 1000.0 / measure->operations);
+
+  if (COUNTS_ALLOCATIONS)
+    g_print (" %11.2f", (gdouble) allocated / measure->operations);
+  else
+    g_print (" %11s", "n/a");
+
+  g_print (" %10ld\n", get_peak_rss ());
+}
+
+static void
+drain_main_loop (void)
+{
+  while (g_main_context_iteration (NULL, FALSE));
+}
+
+static NavigationNode*
+push_jump (NavigationHistory  *history,
+           NavigationPathPool *pool,
+           Jump               *jump)
+{
+  NavigationPath *path;
+  NavigationNode *node;
+  
+  path = navigation_path_pool_lookup (pool, file_paths[jump->file]);
+  if (path != NULL)
+    return navigation_history_push (history, path, jump->line_number);
+
+  path = navigation_path_pool_intern (pool, file_paths[jump->file]);
+  node = navigation_history_push (history, path, jump->line_number);
+  navigation_path_unref (path);
+  
+  return node;
+}
+
+static void
+bench_history (guint capacity)
+{
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  Measure measure;
+  gint i;
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+
+  measure_begin (&measure, "history-push", capacity, operations);
+  for (i = 0; i < operations; i++)
+    push_jump (history, pool, &jumps[i]);
+  measure_end (&measure);
+
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+}
+
+static void
+bench_model (guint capacity)
+{
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  NavigationModel *model;
+  Measure measure;
+  gint i;
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  model = navigation_model_new (history);
+
+  measure_begin (&measure, "model-sync", capacity, operations);
+  for (i = 0; i < operations; i++)
+    {
+      push_jump (history, pool, &jumps[i]);
+      navigation_model_sync (model, G_MAXUINT64);
+    }
+  measure_end (&measure);
+
+  g_object_unref (model);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+}
+
+/*
+ * Types a query into a full model a key at a time, as the pane's filter
+ * entry does. Each key has to fit in a frame.
+ */
+static void
+bench_filter (guint capacity)
+{
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  NavigationModel *model;
+  Measure measure;
+  const gchar *query = "projectmodule1file1:1";
+  gchar *typed;
+  gsize length;
+  gint i;
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  for (i = 0; i < operations; i++)
+    push_jump (history, pool, &jumps[i]);
+  model = navigation_model_new (history);
+
+  length = strlen (query);
+  typed = g_malloc0 (length + 1);
+
+  measure_begin (&measure, "model-filter", capacity, length + 1);
+  for (i = 0; i < (gint) length; i++)
+    {
+      typed[i] = query[i];
+      navigation_model_set_query (model, typed);
+    }
+  navigation_model_set_query (model, "");
+  measure_end (&measure);
+
+  g_free (typed);
+  g_object_unref (model);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+}
+
+static void
+bench_hotspots (guint capacity)
+{
+  NavigationHotspots *hotspots;
+  NavigationHotspot *top[10];
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  Measure measure;
+  gint i;
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  hotspots = navigation_hotspots_new (capacity);
+
+  measure_begin (&measure, "hotspot-visit", capacity, operations);
+  for (i = 0; i < operations; i++)
+    {
+      NavigationNode *node;
+      node = push_jump (history, pool, &jumps[i]);
+      navigation_hotspots_visit (hotspots, navigation_node_get_path (node), 
+                                 navigation_node_get_line_number (node), 
+                                 navigation_node_get_timestamp (node));
+      navigation_hotspots_get_top (hotspots, top, G_N_ELEMENTS (top));
+    }
+  measure_end (&measure);
+
+  navigation_hotspots_free (hotspots);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+}
+
+static void
+journal_loaded (NavigationJournal *journal,
+                GAsyncResult      *result,
+                GAsyncResult     **out)
+{
+  *out = g_object_ref (result);
+}
+
+static void
+bench_journal (guint        capacity,
+               const gchar *folder_path)
+{
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  NavigationJournal *journal;
+  GAsyncResult *result = NULL;
+  Measure measure;
+  gchar *file_path;
+  gint i;
+
+  file_path = g_build_filename (folder_path, "navigation.journal", NULL);
+  g_unlink (file_path);
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  journal = navigation_journal_new (file_path);
+  navigation_journal_compact (journal, history);
+
+  measure_begin (&measure, "journal-write", capacity, operations);
+  for (i = 0; i < operations; i++)
+    navigation_journal_push (journal, push_jump (history, pool, &jumps[i]));
+  navigation_journal_compact (journal, history);
+  navigation_journal_close (journal);
+  measure_end (&measure);
+
+  g_object_unref (journal);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  journal = navigation_journal_new (file_path);
+
+  measure_begin (&measure, "journal-load", capacity, capacity);
+  navigation_journal_load_async (journal, NULL, (GAsyncReadyCallback) journal_loaded, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  navigation_journal_load_finish (journal, result, history, pool, NULL);
+  measure_end (&measure);
+
+  if (navigation_history_get_length (history) != MIN (capacity, (guint) operations))
+    g_printerr ("journal-load restored %u of %u entries\n", 
+                navigation_history_get_length (history), MIN (capacity, (guint) operations));
+
+  navigation_journal_close (journal);
+  g_object_unref (result);
+  g_object_unref (journal);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+  
+  g_unlink (file_path);
+  g_free (file_path);
+}
+
+static void
+bench_pane (guint       capacity,
+            CodeSlayer *codeslayer)
+{
+  NavigationHistory *history;
+  NavigationPathPool *pool;
+  GtkWidget *window;
+  GtkWidget *pane;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  Measure measure;
+  gint i;
+
+  pool = navigation_path_pool_new ();
+  history = navigation_history_new (capacity);
+  
+  pane = navigation_pane_new (codeslayer, history, NULL);
+  window = gtk_offscreen_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 300, 600);
+  gtk_container_add (GTK_CONTAINER (window), pane);
+  gtk_widget_show_all (window);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 300, 600);
+  cr = cairo_create (surface);
+
+  measure_begin (&measure, "pane-refresh", capacity, operations);
+  for (i = 0; i < operations; i++)
+    {
+      push_jump (history, pool, &jumps[i]);
+      navigation_pane_refresh (NAVIGATION_PANE (pane), G_MAXUINT64);
+      gtk_widget_draw (pane, cr);
+    }
+  measure_end (&measure);
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+  navigation_history_free (history);
+  navigation_path_pool_free (pool);
+}
+
+static void
+write_config (const gchar *folder_path,
+              guint        capacity)
+{
+  GKeyFile *key_file;
+  gchar *file_path;
+
+  file_path = codeslayer_utils_get_file_path (folder_path, "navigation.conf");
+  key_file = g_key_file_new ();
+  g_key_file_set_boolean (key_file, "main", "show_side_pane", TRUE);
+  g_key_file_set_integer (key_file, "main", "history_capacity", capacity);
+  g_key_file_set_integer (key_file, "main", "select_delay", 0);
+  g_key_file_set_boolean (key_file, "main", "persist_history", FALSE);
+  g_key_file_set_boolean (key_file, "main", "validate_files", FALSE);
+  codeslayer_utils_save_key_file (key_file, file_path);
+  
+  g_key_file_free (key_file);
+  g_free (file_path);
+}
+
+static void
+navigate (CodeSlayer *codeslayer,
+          Jump       *from,
+          Jump       *to)
+{
+  g_signal_emit_by_name (codeslayer, "path-navigated", 
+                         file_paths[from->file], from->line_number,
+                         file_paths[to->file], to->line_number);
+}
+
+static void
+bench_engine (guint        capacity,
+              CodeSlayer  *codeslayer,
+              const gchar *folder_path)
+{
+  NavigationEngine *engine;
+  GtkWidget *menu;
+  Measure measure;
+  guint walked;
+  gint i;
+
+  write_config (folder_path, capacity);
+
+  menu = navigation_menu_new (codeslayer_get_menu_bar_accel_group (codeslayer));
+  codeslayer_add_to_menu_bar (codeslayer, GTK_MENU_ITEM (menu));
+  engine = navigation_engine_new (codeslayer, menu);
+
+  measure_begin (&measure, "engine-storm", capacity, operations - 1);
+  for (i = 1; i < operations; i++)
+    {
+      navigate (codeslayer, &jumps[i - 1], &jumps[i]);
+      if (i % DRAIN_INTERVAL == 0)
+        drain_main_loop ();
+    }
+  drain_main_loop ();
+  measure_end (&measure);
+
+  /* walk to the oldest entry and back again, over and over */
+  walked = MIN (capacity, (guint) operations) - 1;
+
+  measure_begin (&measure, "engine-walk", capacity, operations);
+  for (i = 0; i < operations; i++)
+    {
+      if (walked == 0 || (i / walked) % 2 == 0)
+        g_signal_emit_by_name (menu, "previous");
+      else
+        g_signal_emit_by_name (menu, "next");
+      if (i % DRAIN_INTERVAL == 0)
+        drain_main_loop ();
+    }
+  drain_main_loop ();
+  measure_end (&measure);
+
+  g_object_unref (engine);
+  codeslayer_remove_from_menu_bar (codeslayer, GTK_MENU_ITEM (menu));
+}
+
+static gpointer
+push_thread (Pusher *pusher)
+{
+  gchar *to_file_path;
+  gint i;
+
+  to_file_path = g_strdup_printf (PUSH_FILE "%u.c", pusher->thread);
+  for (i = 1; i <= pusher->count; i++)
+    navigation_engine_push (pusher->engine, "/bench/push/origin.c", 1, to_file_path, i);
+  g_free (to_file_path);
+
+  /* held the way another plugin would hold one from navigation_get_engine */
+  navigation_engine_unref (pusher->engine);
+
+  return NULL;
+}
+
+static gboolean
+check_entry (const gchar *file_path,
+             gint         line_number,
+             gint64       timestamp,
+             PushCheck   *check)
+{
+  guint thread;
+
+  check->done = g_strcmp0 (file_path, PUSH_DONE) == 0;
+
+  if (!g_str_has_prefix (file_path, PUSH_FILE))
+    return TRUE;
+
+  thread = atoi (file_path + strlen (PUSH_FILE));
+  if (thread >= PUSH_THREADS)
+    return TRUE;
+
+  if (line_number <= check->last[thread])
+    check->ordered = FALSE;
+  check->last[thread] = line_number;
+
+  return TRUE;
+}
+
+static void
+read_pushed (NavigationEngine *engine,
+             PushCheck        *check)
+{
+  NavigationSnapshot *snapshot;
+
+  memset (check, 0, sizeof (PushCheck));
+  check->ordered = TRUE;
+
+  snapshot = navigation_engine_get_snapshot (engine);
+  navigation_snapshot_foreach (snapshot, (NavigationSnapshotFunc) check_entry, check);
+  navigation_snapshot_unref (snapshot);
+}
+
+/*
+ * Readers asking while nothing changes share one snapshot, and one held
+ * across a change keeps what it saw while the next reader gets a new epoch.
+ */
+static void
+check_snapshots (NavigationEngine *engine)
+{
+  NavigationSnapshot *first;
+  NavigationSnapshot *second;
+  NavigationSnapshot *after;
+  guint length;
+  gint64 deadline;
+
+  first = navigation_engine_get_snapshot (engine);
+  second = navigation_engine_get_snapshot (engine);
+  length = navigation_snapshot_get_length (first);
+
+  if (first != second)
+    {
+      g_printerr ("engine-snapshot: unchanged history not shared\n");
+      failed = TRUE;
+    }
+  navigation_snapshot_unref (second);
+
+  navigation_engine_push (engine, PUSH_DONE, 1, "/bench/push/snapshot.c", 1);
+
+  deadline = g_get_monotonic_time () + PUSH_TIMEOUT;
+  do
+    {
+      drain_main_loop ();
+      after = navigation_engine_get_snapshot (engine);
+      if (navigation_snapshot_get_epoch (after) != navigation_snapshot_get_epoch (first))
+        break;
+      navigation_snapshot_unref (after);
+      after = NULL;
+      g_usleep (1000);
+    }
+  while (g_get_monotonic_time () < deadline);
+
+  if (after == NULL || navigation_snapshot_get_epoch (after) <= navigation_snapshot_get_epoch (first) ||
+      navigation_snapshot_get_length (first) != length)
+    {
+      g_printerr ("engine-snapshot: push did not move to a new epoch\n");
+      failed = TRUE;
+    }
+
+  if (after != NULL)
+    navigation_snapshot_unref (after);
+  navigation_snapshot_unref (first);
+  drain_main_loop ();
+}
+
+/*
+ * Several threads push at once through the thread safe API. Every thread's
+ * jumps have to come out in the order it pushed them, and when the history
+ * can hold them all, none may be missing.
+ */
+static void
+bench_push (guint        capacity,
+            CodeSlayer  *codeslayer,
+            const gchar *folder_path)
+{
+  NavigationEngine *engine;
+  GtkWidget *menu;
+  GThread *threads[PUSH_THREADS];
+  Pusher pushers[PUSH_THREADS];
+  PushCheck check;
+  Measure measure;
+  gint64 deadline;
+  gint count;
+  guint i;
+
+  write_config (folder_path, capacity);
+
+  menu = navigation_menu_new (codeslayer_get_menu_bar_accel_group (codeslayer));
+  codeslayer_add_to_menu_bar (codeslayer, GTK_MENU_ITEM (menu));
+  engine = navigation_engine_new (codeslayer, menu);
+
+  count = MAX (1, operations / PUSH_THREADS);
+
+  measure_begin (&measure, "engine-push", capacity, count * PUSH_THREADS);
+  for (i = 0; i < PUSH_THREADS; i++)
+    {
+      pushers[i].engine = navigation_engine_ref (engine);
+      pushers[i].thread = i;
+      pushers[i].count = count;
+      threads[i] = g_thread_new ("navigation-push", (GThreadFunc) push_thread, &pushers[i]);
+    }
+  for (i = 0; i < PUSH_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* pushed after every thread is done, so it is taken in last */
+  navigation_engine_push (engine, PUSH_DONE, 1, PUSH_DONE, 1);
+
+  deadline = g_get_monotonic_time () + PUSH_TIMEOUT;
+  do
+    {
+      drain_main_loop ();
+      read_pushed (engine, &check);
+      if (!check.done)
+        g_usleep (1000);
+    }
+  while (!check.done && g_get_monotonic_time () < deadline);
+  measure_end (&measure);
+
+  if (!check.done || !check.ordered)
+    {
+      g_printerr ("engine-push: %s\n", check.done ? "jumps out of order" : "jumps not taken in");
+      failed = TRUE;
+    }
+
+  /* every jump may record its origin too */
+  for (i = 0; check.done && capacity >= 2 * (guint) count * PUSH_THREADS + 2 && i < PUSH_THREADS; i++)
+    {
+      if (check.last[i] != count)
+        {
+          g_printerr ("engine-push: jumps from thread %u missing\n", i);
+          failed = TRUE;
+          break;
+        }
+    }
+
+  check_snapshots (engine);
+
+  g_object_unref (engine);
+  codeslayer_remove_from_menu_bar (codeslayer, GTK_MENU_ITEM (menu));
+}
+
+static void
+create_jumps (void)
+{
+  GRand *rand;
+  gint i;
+
+  /* half the files belong to a project and half do not */
+  file_paths = g_new0 (gchar*, file_count + 1);
+  for (i = 0; i < file_count; i++)
+    file_paths[i] = g_strdup_printf ("/bench/%s/src/module%d/file%d.c", 
+                                     i % 2 ? "project" : "outside", i % 17, i);
+
+  rand = g_rand_new_with_seed (42);
+  jumps = g_new (Jump, operations);
+  for (i = 0; i < operations; i++)
+    {
+      jumps[i].file = g_rand_int_range (rand, 0, file_count);
+      jumps[i].line_number = g_rand_int_range (rand, 1, 5000);
+    }
+  g_rand_free (rand);
+}
+
+int
+main (int   argc, 
+      char *argv[])
+{
+  GOptionContext *context;
+  CodeSlayer *codeslayer;
+  GError *error = NULL;
+  gchar **sizes;
+  gchar *folder_path;
+  gchar *file_path;
+  gboolean has_display;
+  gint i;
+
+  g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+  context = g_option_context_new ("- benchmark the navigation plugin");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (FALSE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+  g_option_context_free (context);
+
+  if (operations < 2 || file_count < 1)
+    {
+      g_printerr ("need at least 2 operations and 1 file\n");
+      return EXIT_FAILURE;
+    }
+
+  has_display = gtk_init_check (NULL, NULL);
+
+  folder_path = g_dir_make_tmp ("navigation-bench-XXXXXX", &error);
+  if (folder_path == NULL)
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  codeslayer = codeslayer_stub_new (folder_path);
+  codeslayer_stub_add_project (codeslayer, "project", "/bench/project");
+
+  create_jumps ();
+
+  g_print ("%-14s %9s %9s %12s %11s %10s\n", 
+           "benchmark", "capacity", "ops", "ns/op", "allocs/op", "peak KiB");
+
+  sizes = g_strsplit (capacities, ",", -1);
+  for (i = 0; sizes[i] != NULL; i++)
+    {
+      guint capacity = MAX (2, atoi (sizes[i]));
+
+      bench_history (capacity);
+      bench_model (capacity);
+      bench_filter (capacity);
+      bench_hotspots (capacity);
+      bench_journal (capacity, folder_path);
+      
+      if (has_display)
+        {
+          bench_pane (capacity, codeslayer);
+          bench_engine (capacity, codeslayer, folder_path);
+          bench_push (capacity, codeslayer, folder_path);
+        }
+    }
+  g_strfreev (sizes);
+
+  if (!has_display)
+    g_print ("no display, skipped the pane and engine benchmarks\n");
+
+  g_object_unref (codeslayer);
+
+  file_path = codeslayer_utils_get_file_path (folder_path, "navigation.conf");
+  g_unlink (file_path);
+  g_free (file_path);
+  g_rmdir (folder_path);
+  g_free (folder_path);
+
+  g_strfreev (file_paths);
+  g_free (jumps);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
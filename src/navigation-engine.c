@@ -16,9 +16,21 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
+#include <gmodule.h>
 #include "navigation-engine.h"
 #include "navigation-pane.h"
 #include "navigation-node.h"
+#include "navigation-history.h"
+#include "navigation-path.h"
+#include "navigation-journal.h"
+#include "navigation-hotspots.h"
+#include "navigation-validator.h"
+#include "navigation-prefetcher.h"
+#include "navigation-fingerprint.h"
+#include "navigation-settings.h"
+#include "navigation-stats.h"
+#include "navigation-ingest.h"
+#include "navigation-probes.h"
 
 static void navigation_engine_class_init  (NavigationEngineClass *klass);
 static void navigation_engine_init        (NavigationEngine      *engine);
@@ -29,316 +41,1765 @@ static void path_navigated_action         (NavigationEngine      *engine,
                                            gint                   from_line_number,
                                            gchar                 *to_file_path,
                                            gint                   to_line_number);
+static void projects_changed_action       (NavigationEngine      *engine);
 static void previous_action               (NavigationEngine      *engine);
 static void next_action                   (NavigationEngine      *engine);
+static void previous_branch_action        (NavigationEngine      *engine);
+static void next_branch_action            (NavigationEngine      *engine);
 static void select_position_action        (NavigationEngine      *engine, 
                                            gint                   position);
-static void clear_path                    (NavigationEngine      *engine);
+static void select_location_action        (NavigationEngine      *engine, 
+                                           gchar                 *file_path,
+                                           gint                   line_number);
+static void mark_missing                  (NavigationEngine      *engine,
+                                           NavigationNode        *node);
+static void cancel_select_document        (NavigationEngine      *engine);
 static void toggle_dialog_action          (GtkToggleButton       *toggle_button,
                                            NavigationEngine      *engine);
-static void add_pane                     (NavigationEngine      *engine);
+static void save_stats_action             (NavigationEngine      *engine);
+static void reset_stats_action            (NavigationEngine      *engine);
+static void update_pane                   (NavigationEngine      *engine);
+static void update_history_capacity       (NavigationEngine      *engine);
+static void update_validator              (NavigationEngine      *engine);
+static void update_prefetcher             (NavigationEngine      *engine);
+static void load_settings                 (NavigationEngine      *engine);
+static void track_editor                  (NavigationEngine      *engine,
+                                           CodeSlayerEditor      *editor);
+static void buffer_finalized              (NavigationEngine      *engine,
+                                           GObject               *buffer);
+static void anchor_nodes                  (NavigationEngine      *engine,
+                                           const gchar           *file_path);
+static void load_journal                  (NavigationEngine      *engine);
+static void finish_loading                (NavigationEngine      *engine);
+static void schedule_refresh              (NavigationEngine      *engine);
+static void bump_epoch                    (NavigationEngine      *engine);
+static void schedule_prefetch             (NavigationEngine      *engine);
+static gboolean start_fingerprints        (NavigationEngine      *engine);
 
 #define NAVIGATION_ENGINE_GET_PRIVATE(obj) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_ENGINE_TYPE, NavigationEnginePrivate))
 
-#define MAIN "main"
-#define SHOW_SIDE_PANE "show_side_pane"
+#define CONFIG_FILE "navigation.conf"
+#define JOURNAL_FILE "navigation.journal"
+#define PARTITION_JOURNAL_FILE "navigation-%s.journal"
+#define HOTSPOT_LIMIT 1024
+#define STATS_FILE "navigation.stats"
+
+/*
+ * A history and its journal. There is one for files outside any project,
+ * keyed by the empty string, and with partition_by_project one for each
+ * project, keyed by its folder path. truncated_at is kept per partition
+ * because the pane keeps a model per history and catches up with one only
+ * while it shows it.
+ */
+typedef struct
+{
+  gchar             *key;
+  NavigationHistory *history;
+  NavigationJournal *journal;
+  guint64            truncated_at;
+} Partition;
 
 typedef struct _NavigationEnginePrivate NavigationEnginePrivate;
 
-struct _NavigationEnginePrivate
+struct _NavigationEnginePrivate
+{
+  CodeSlayer         *codeslayer;
+  GtkWidget          *pane;
+  gulong              path_navigated_id;
+  gulong              editor_added_id;
+  gulong              projects_changed_id;
+  GHashTable         *buffers;
+  NavigationHistory  *history;
+  GHashTable         *partitions;
+  Partition          *partition;
+  guint               partition_generation;
+  NavigationPathPool *path_pool;
+  guint               select_id;
+  guint               refresh_id;
+  guint               refresh_requests;
+  guint               coalesced_refreshes;
+  NavigationJournal  *journal;
+  GCancellable       *load_cancellable;
+  gboolean            loading;
+  GQueue             *deferred;
+  NavigationHotspots *hotspots;
+  NavigationValidator *validator;
+  NavigationPrefetcher *prefetcher;
+  guint               prefetch_id;
+  NavigationSettings *settings;
+  gint64              started;
+  NavigationStats    *stats;
+  NavigationIngest   *ingest;
+  NavigationSnapshot *snapshot;
+  guint64             epoch;
+  GArray             *fingerprints;
+  GArray             *spare_fingerprints;
+  guint               fingerprint_id;
+  gboolean            fingerprinting;
+  GCancellable       *fingerprint_cancellable;
+  GtkTextBuffer      *stats_buffer;
+};
+
+typedef struct
+{
+  Partition      *partition;
+  guint64         id;
+  NavigationPath *path;
+  gint            line_number;
+  guint32         fingerprint;
+} PendingFingerprint;
+
+typedef struct
+{
+  gchar *from_file_path;
+  gint   from_line_number;
+  gchar *to_file_path;
+  gint   to_line_number;
+} DeferredNavigation;
+
+G_DEFINE_TYPE (NavigationEngine, navigation_engine, G_TYPE_OBJECT)
+
+static void
+navigation_engine_class_init (NavigationEngineClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = (GObjectFinalizeFunc) navigation_engine_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationEnginePrivate));
+}
+
+static void
+navigation_engine_init (NavigationEngine *engine) 
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  priv->history = NULL;
+  priv->partitions = NULL;
+  priv->partition = NULL;
+  priv->partition_generation = 1;
+  priv->buffers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->path_pool = navigation_path_pool_new ();
+  priv->pane = NULL;
+  priv->select_id = 0;
+  priv->refresh_id = 0;
+  priv->refresh_requests = 0;
+  priv->coalesced_refreshes = 0;
+  priv->journal = NULL;
+  priv->load_cancellable = NULL;
+  priv->loading = FALSE;
+  priv->deferred = g_queue_new ();
+  priv->hotspots = navigation_hotspots_new (HOTSPOT_LIMIT);
+  priv->validator = NULL;
+  priv->prefetcher = NULL;
+  priv->prefetch_id = 0;
+  priv->settings = NULL;
+  priv->started = 0;
+  priv->stats = navigation_stats_new ();
+  priv->ingest = navigation_ingest_new ((NavigationIngestFunc) path_navigated_action, engine);
+  priv->snapshot = NULL;
+  priv->epoch = 0;
+  priv->fingerprints = g_array_new (FALSE, FALSE, sizeof (PendingFingerprint));
+  priv->spare_fingerprints = NULL;
+  priv->fingerprint_id = 0;
+  priv->fingerprinting = FALSE;
+  priv->fingerprint_cancellable = g_cancellable_new ();
+  priv->stats_buffer = NULL;
+}
+
+static void
+partition_free (Partition *partition)
+{
+  if (partition->journal != NULL)
+    {
+      navigation_journal_close (partition->journal);
+      g_object_unref (partition->journal);
+    }
+
+  navigation_history_free (partition->history);
+  g_free (partition->key);
+  g_slice_free (Partition, partition);
+}
+
+static void
+deferred_navigation_free (DeferredNavigation *deferred)
+{
+  g_free (deferred->from_file_path);
+  g_free (deferred->to_file_path);
+  g_slice_free (DeferredNavigation, deferred);
+}
+
+/* the paths are only let go of on the main thread */
+static void
+fingerprints_clear (GArray *fingerprints)
+{
+  guint i;
+  for (i = 0; i < fingerprints->len; i++)
+    navigation_path_unref (g_array_index (fingerprints, PendingFingerprint, i).path);
+  g_array_set_size (fingerprints, 0);
+}
+
+static void
+navigation_engine_finalize (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  GHashTableIter iter;
+  gpointer buffer;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->pane != NULL)
+    codeslayer_remove_from_side_pane (priv->codeslayer, priv->pane);
+
+  g_signal_handler_disconnect (priv->codeslayer, priv->path_navigated_id);
+  g_signal_handler_disconnect (priv->codeslayer, priv->editor_added_id);
+  g_signal_handler_disconnect (priv->codeslayer, priv->projects_changed_id);
+  
+  navigation_ingest_free (priv->ingest);
+  
+  if (priv->snapshot != NULL)
+    navigation_snapshot_unref (priv->snapshot);
+
+  if (priv->refresh_id != 0)
+    g_source_remove (priv->refresh_id);
+
+  if (priv->select_id != 0)
+    g_source_remove (priv->select_id);
+
+  if (priv->prefetch_id != 0)
+    g_source_remove (priv->prefetch_id);
+
+  if (priv->load_cancellable != NULL)
+    {
+      g_cancellable_cancel (priv->load_cancellable);
+      g_object_unref (priv->load_cancellable);
+    }
+
+  g_queue_free_full (priv->deferred, (GDestroyNotify) deferred_navigation_free);
+
+  /* a batch still being read sees this and leaves the histories alone */
+  g_cancellable_cancel (priv->fingerprint_cancellable);
+  g_object_unref (priv->fingerprint_cancellable);
+  
+  if (priv->fingerprint_id != 0)
+    g_source_remove (priv->fingerprint_id);
+  
+  fingerprints_clear (priv->fingerprints);
+  g_array_free (priv->fingerprints, TRUE);
+  if (priv->spare_fingerprints != NULL)
+    g_array_free (priv->spare_fingerprints, TRUE);
+
+  if (priv->validator != NULL)
+    g_object_unref (priv->validator);
+
+  if (priv->prefetcher != NULL)
+    g_object_unref (priv->prefetcher);
+
+  if (priv->settings != NULL)
+    g_object_unref (priv->settings);
+
+  /* freeing the histories deletes the marks, so the buffers go after them */
+  if (priv->partitions != NULL)
+    g_hash_table_destroy (priv->partitions);
+  
+  g_hash_table_iter_init (&iter, priv->buffers);
+  while (g_hash_table_iter_next (&iter, NULL, &buffer))
+    g_object_weak_unref (buffer, (GWeakNotify) buffer_finalized, engine);
+  g_hash_table_destroy (priv->buffers);
+  
+  navigation_hotspots_free (priv->hotspots);
+  
+  navigation_stats_free (priv->stats);
+  
+  navigation_path_pool_free (priv->path_pool);
+  
+  G_OBJECT_CLASS (navigation_engine_parent_class)->finalize (G_OBJECT (engine));
+}
+
+NavigationEngine*
+navigation_engine_new (CodeSlayer *codeslayer, 
+                       GtkWidget  *menu)
+{
+  NavigationEnginePrivate *priv;
+  NavigationEngine *engine;
+  GList *editors;
+  GList *list;
+
+  engine = NAVIGATION_ENGINE (g_object_new (navigation_engine_get_type (), NULL));
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+
+  priv->codeslayer = codeslayer;
+  priv->started = g_get_monotonic_time ();
+  
+  load_settings (engine);
+  
+  g_signal_connect_swapped (G_OBJECT (menu), "previous", 
+                            G_CALLBACK (previous_action), engine);
+  
+  g_signal_connect_swapped (G_OBJECT (menu), "next", 
+                            G_CALLBACK (next_action), engine);
+  
+  g_signal_connect_swapped (G_OBJECT (menu), "previous-branch", 
+                            G_CALLBACK (previous_branch_action), engine);
+  
+  g_signal_connect_swapped (G_OBJECT (menu), "next-branch", 
+                            G_CALLBACK (next_branch_action), engine);
+
+  priv->path_navigated_id = g_signal_connect_swapped (G_OBJECT (codeslayer), "path-navigated", 
+                                                        G_CALLBACK (path_navigated_action), engine);
+
+  priv->editor_added_id = g_signal_connect_swapped (G_OBJECT (codeslayer), "editor-added", 
+                                                    G_CALLBACK (track_editor), engine);
+
+  priv->projects_changed_id = g_signal_connect_swapped (G_OBJECT (codeslayer), "projects-changed", 
+                                                        G_CALLBACK (projects_changed_action), engine);
+  
+  editors = codeslayer_get_all_editors (codeslayer);
+  for (list = editors; list != NULL; list = list->next)
+    track_editor (engine, CODESLAYER_EDITOR (list->data));
+  g_list_free (editors);
+                                                      
+  return engine;
+}
+
+/*
+ * The journal only ever grows, so once it holds a few times more records
+ * than the history can it is rewritten from the live entries.
+ */
+static void
+compact_journal (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  guint limit;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  limit = navigation_history_get_capacity (priv->history) * 4 + 64;
+  
+  if (navigation_journal_get_record_count (priv->journal) > limit)
+    navigation_journal_compact (priv->journal, priv->history);
+}
+
+static void
+log_position (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->journal != NULL)
+    navigation_journal_set_position (priv->journal, 
+                                     navigation_history_get_position (priv->history));
+}
+
+/*
+ * Records that the pane rows from length onwards no longer match the trail,
+ * because it was cut there or switched to another branch.
+ */
+static void
+mark_trail_changed (NavigationEngine *engine, 
+                    guint             length)
+{
+  NavigationEnginePrivate *priv;
+  guint64 truncated_at;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  truncated_at = navigation_history_get_offset (priv->history) + length;
+  priv->partition->truncated_at = MIN (priv->partition->truncated_at, truncated_at);
+}
+
+static void
+fingerprint_thread (GTask        *task,
+                    gpointer      source_object,
+                    GArray       *fingerprints,
+                    GCancellable *cancellable)
+{
+  guint i;
+
+  for (i = 0; i < fingerprints->len; i++)
+    {
+      PendingFingerprint *pending;
+      
+      if (g_task_return_error_if_cancelled (task))
+        return;
+      
+      pending = &g_array_index (fingerprints, PendingFingerprint, i);
+      pending->fingerprint = navigation_fingerprint_from_file (navigation_path_get_file_path (pending->path), 
+                                                               pending->line_number);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+fingerprints_done (GObject          *source_object,
+                   GAsyncResult     *result,
+                   NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  GArray *fingerprints;
+  guint i;
+
+  fingerprints = g_task_get_task_data (G_TASK (result));
+
+  /* the engine is already gone */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    {
+      fingerprints_clear (fingerprints);
+      g_array_free (fingerprints, TRUE);
+      return;
+    }
+
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  priv->fingerprinting = FALSE;
+
+  for (i = 0; i < fingerprints->len; i++)
+    {
+      PendingFingerprint *pending;
+      NavigationNode *node;
+      
+      pending = &g_array_index (fingerprints, PendingFingerprint, i);
+      
+      /* ids are never reused, so a node still there is the one asked about;
+         an anchored one gets its fingerprint from the buffer once that closes */
+      node = navigation_history_lookup (pending->partition->history, pending->id);
+      if (node == NULL || navigation_node_is_anchored (node) || 
+          navigation_node_get_fingerprint (node) != 0 || pending->fingerprint == 0)
+        continue;
+      
+      navigation_node_set_fingerprint (node, pending->fingerprint);
+      if (pending->partition->journal != NULL)
+        navigation_journal_set_fingerprint (pending->partition->journal, 
+                                            pending->partition->history, 
+                                            pending->id, pending->fingerprint);
+    }
+
+  /* the two arrays take turns, so a steady stream of jumps allocates nothing */
+  fingerprints_clear (fingerprints);
+  if (priv->spare_fingerprints == NULL)
+    priv->spare_fingerprints = fingerprints;
+  else
+    g_array_free (fingerprints, TRUE);
+
+  start_fingerprints (engine);
+}
+
+/*
+ * Hands everything queued since the last batch to one worker task.
+ */
+static gboolean
+start_fingerprints (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  GTask *task;
+
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  priv->fingerprint_id = 0;
+
+  if (priv->fingerprinting || priv->fingerprints->len == 0)
+    return FALSE;
+
+  priv->fingerprinting = TRUE;
+
+  task = g_task_new (NULL, priv->fingerprint_cancellable, 
+                     (GAsyncReadyCallback) fingerprints_done, engine);
+  g_task_set_task_data (task, priv->fingerprints, NULL);
+  g_task_run_in_thread (task, (GTaskThreadFunc) fingerprint_thread);
+  g_object_unref (task);
+
+  if (priv->spare_fingerprints != NULL)
+    priv->fingerprints = priv->spare_fingerprints;
+  else
+    priv->fingerprints = g_array_new (FALSE, FALSE, sizeof (PendingFingerprint));
+  priv->spare_fingerprints = NULL;
+
+  return FALSE;
+}
+
+/*
+ * The line of a file that is not open is hashed from a worker thread. The
+ * jumps made before the main loop next goes idle, or while a batch is
+ * still being read, go together in one batch, and each fingerprint is
+ * set on its node and journaled as it comes back.
+ */
+static void
+queue_fingerprint (NavigationEngine *engine,
+                   NavigationNode   *node)
+{
+  NavigationEnginePrivate *priv;
+  PendingFingerprint pending;
+
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+
+  pending.partition = priv->partition;
+  pending.id = navigation_history_get_next_id (priv->history) - 1;
+  pending.path = navigation_path_ref (navigation_node_get_path (node));
+  pending.line_number = navigation_node_get_line_number (node);
+  pending.fingerprint = 0;
+  g_array_append_val (priv->fingerprints, pending);
+
+  if (!priv->fingerprinting && priv->fingerprint_id == 0)
+    priv->fingerprint_id = g_idle_add ((GSourceFunc) start_fingerprints, engine);
+}
+
+static NavigationNode*
+push_node (NavigationEngine *engine,
+           gchar            *file_path,
+           gint              line_number,
+           gboolean          origin)
+{
+  NavigationEnginePrivate *priv;
+  NavigationPath *path;
+  NavigationNode *node;
+  GtkTextBuffer *buffer;
+  gint position;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  /* the forward entries move off the trail onto their own branch */
+  position = navigation_history_get_position (priv->history);
+  if (position + 1 < (gint) navigation_history_get_length (priv->history))
+    mark_trail_changed (engine, position + 1);
+  
+  path = navigation_path_pool_lookup (priv->path_pool, file_path);
+  if (path != NULL)
+    {
+      node = navigation_history_push (priv->history, path, line_number);
+    }
+  else
+    {
+      path = navigation_path_pool_intern (priv->path_pool, file_path);
+      node = navigation_history_push (priv->history, path, line_number);
+      navigation_path_unref (path);
+    }
+  
+  /* CodeSlayer just went there, so the file is back if it was gone */
+  navigation_path_set_missing (navigation_node_get_path (node), FALSE);
+  navigation_node_set_origin (node, origin);
+  
+  buffer = g_hash_table_lookup (priv->buffers, file_path);
+  if (buffer != NULL)
+    {
+      navigation_node_anchor (node, buffer);
+      navigation_node_set_fingerprint (node, navigation_fingerprint_from_buffer (buffer, line_number));
+    }
+  else
+    {
+      queue_fingerprint (engine, node);
+    }
+  
+  if (priv->journal != NULL)
+    {
+      navigation_journal_push (priv->journal, node);
+      compact_journal (engine);
+    }
+  
+  return node;
+}
+
+static gboolean
+refresh_pane (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  priv->refresh_id = 0;
+  priv->coalesced_refreshes += priv->refresh_requests - 1;
+  
+  if (priv->refresh_requests > 1)
+    g_debug ("navigation: coalesced %u pane refreshes into one (%u in total)", 
+             priv->refresh_requests, priv->coalesced_refreshes);
+  
+  if (priv->pane != NULL)
+    {
+      gint64 started = g_get_monotonic_time ();
+      navigation_pane_refresh (NAVIGATION_PANE (priv->pane), priv->partition->truncated_at);
+      navigation_stats_record (priv->stats, NAVIGATION_STAT_PANE_REFRESH, started);
+    }
+  
+  priv->refresh_requests = 0;
+  priv->partition->truncated_at = G_MAXUINT64;
+  
+  return FALSE;
+}
+
+/*
+ * History changes are applied right away but the pane only catches up once
+ * the burst of events is over, so N jumps in a row cost one pane update.
+ */
+static void
+schedule_refresh (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  priv->refresh_requests++;
+  
+  /* every change to the history comes through here */
+  bump_epoch (engine);
+  
+  if (priv->refresh_id == 0)
+    priv->refresh_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, 
+                                        (GSourceFunc) refresh_pane, engine, NULL);
+}
+
+/*
+ * Also called on its own where a line moves without the history changing,
+ * so a snapshot never shows a line the engine has since moved.
+ */
+static void
+bump_epoch (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  priv->epoch++;
+  if (priv->snapshot != NULL)
+    {
+      navigation_snapshot_unref (priv->snapshot);
+      priv->snapshot = NULL;
+    }
+}
+
+static void
+defer_navigation (NavigationEngine *engine,
+                  gchar            *from_file_path,
+                  gint              from_line_number,
+                  gchar            *to_file_path,
+                  gint              to_line_number,
+                  gboolean          front)
+{
+  NavigationEnginePrivate *priv;
+  DeferredNavigation *deferred;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  deferred = g_slice_new (DeferredNavigation);
+  deferred->from_file_path = g_strdup (from_file_path);
+  deferred->from_line_number = from_line_number;
+  deferred->to_file_path = g_strdup (to_file_path);
+  deferred->to_line_number = to_line_number;
+  
+  if (front)
+    g_queue_push_head (priv->deferred, deferred);
+  else
+    g_queue_push_tail (priv->deferred, deferred);
+}
+
+/*
+ * Pushes where the jump was made from, unless the trail already ends there.
+ */
+static void
+push_origin (NavigationEngine *engine,
+             gchar            *from_file_path,
+             gint              from_line_number)
+{
+  NavigationEnginePrivate *priv;
+  NavigationNode *curr_node;
+  NavigationPath *from_path;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (navigation_history_get_length (priv->history) == 0)
+    {
+      push_node (engine, from_file_path, from_line_number, TRUE);
+      return;
+    }
+  
+  curr_node = navigation_history_get_current (priv->history);
+  from_path = navigation_path_pool_lookup (priv->path_pool, from_file_path);
+  
+  if (from_path == NULL || !navigation_node_equals (curr_node, from_path, from_line_number))
+    push_node (engine, from_file_path, from_line_number, TRUE);
+}
+
+/*
+ * Files outside every project, and all files unless partition_by_project is
+ * set, share the partition with the empty key. For a file already in the
+ * path pool the key is cached on its path until the projects change.
+ */
+static const gchar*
+get_partition_key (NavigationEngine *engine,
+                   const gchar      *file_path)
+{
+  NavigationEnginePrivate *priv;
+  CodeSlayerProject *project;
+  NavigationPath *path;
+  const gchar *key;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (file_path == NULL || !navigation_settings_get_partition_by_project (priv->settings))
+    return "";
+  
+  path = navigation_path_pool_lookup (priv->path_pool, file_path);
+  if (path != NULL)
+    {
+      key = navigation_path_get_partition_key (path, priv->partition_generation);
+      if (key != NULL)
+        return key;
+    }
+  
+  project = codeslayer_get_project_by_file_path (priv->codeslayer, file_path);
+  key = project != NULL ? codeslayer_project_get_folder_path (project) : "";
+  
+  if (path != NULL)
+    navigation_path_set_partition_key (path, g_strdup (key), priv->partition_generation);
+  
+  return key;
+}
+
+static void
+projects_changed_action (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  priv->partition_generation++;
+}
+
+static Partition*
+add_partition (NavigationEngine *engine,
+               const gchar      *key)
+{
+  NavigationEnginePrivate *priv;
+  Partition *partition;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  partition = g_slice_new0 (Partition);
+  partition->key = g_strdup (key);
+  partition->history = navigation_history_new (navigation_settings_get_history_capacity (priv->settings));
+  partition->truncated_at = G_MAXUINT64;
+  g_hash_table_insert (priv->partitions, partition->key, partition);
+  
+  return partition;
+}
+
+/*
+ * Makes the partition of file_path the current one, which is a matter of
+ * swapping pointers once it exists. A partition seen for the first time
+ * restores its journal, and FALSE is returned until that is in.
+ */
+static gboolean
+select_partition (NavigationEngine *engine,
+                  const gchar      *file_path)
+{
+  NavigationEnginePrivate *priv;
+  Partition *partition;
+  const gchar *key;
+  gboolean created;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  key = get_partition_key (engine, file_path);
+  if (g_strcmp0 (key, priv->partition->key) == 0)
+    return TRUE;
+  
+  partition = g_hash_table_lookup (priv->partitions, key);
+  created = partition == NULL;
+  if (created)
+    partition = add_partition (engine, key);
+  
+  g_debug ("navigation: switched to the history of '%s'", key);
+  
+  priv->partition = partition;
+  priv->history = partition->history;
+  priv->journal = partition->journal;
+  
+  if (priv->pane != NULL)
+    navigation_pane_set_history (NAVIGATION_PANE (priv->pane), priv->history);
+  
+  schedule_refresh (engine);
+  
+  if (created && navigation_settings_get_persist_history (priv->settings))
+    {
+      load_journal (engine);
+      return FALSE;
+    }
+  
+  return TRUE;
+}
+
+static void
+path_navigated_action (NavigationEngine *engine,
+                       gchar            *from_file_path,
+                       gint              from_line_number,
+                       gchar            *to_file_path,
+                       gint              to_line_number)
+{
+  NavigationEnginePrivate *priv;
+  NavigationNode *node;
+  gint64 started;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->loading)
+    {
+      defer_navigation (engine, from_file_path, from_line_number, 
+                        to_file_path, to_line_number, FALSE);
+      return;
+    }
+  
+  /* it goes back in front of anything queued after it while the partition loads */
+  if (!select_partition (engine, to_file_path))
+    {
+      defer_navigation (engine, from_file_path, from_line_number, 
+                        to_file_path, to_line_number, TRUE);
+      return;
+    }
+  
+  started = g_get_monotonic_time ();
+  
+  cancel_select_document (engine);
+  
+  /* a jump in from another partition starts at the destination */
+  if (g_strcmp0 (get_partition_key (engine, from_file_path), priv->partition->key) == 0)
+    push_origin (engine, from_file_path, from_line_number);
+  
+  node = push_node (engine, to_file_path, to_line_number, FALSE);
+  
+  navigation_hotspots_visit (priv->hotspots, navigation_node_get_path (node), 
+                             to_line_number, navigation_node_get_timestamp (node));
+
+  schedule_refresh (engine);
+  schedule_prefetch (engine);
+  
+  navigation_stats_record (priv->stats, NAVIGATION_STAT_PATH_NAVIGATED, started);
+}
+
+G_MODULE_EXPORT NavigationEngine*
+navigation_engine_ref (NavigationEngine *engine)
+{
+  g_return_val_if_fail (IS_NAVIGATION_ENGINE (engine), NULL);
+  return g_object_ref (engine);
+}
+
+static gboolean
+engine_unref (NavigationEngine *engine)
+{
+  g_object_unref (engine);
+  return FALSE;
+}
+
+/*
+ * The last reference may be the one a worker thread held on to after the
+ * plugin was deactivated, and the engine has widgets to take down, so the
+ * reference is always dropped on the main loop.
+ */
+G_MODULE_EXPORT void
+navigation_engine_unref (NavigationEngine *engine)
+{
+  g_return_if_fail (IS_NAVIGATION_ENGINE (engine));
+  g_idle_add ((GSourceFunc) engine_unref, engine);
+}
+
+/*
+ * Records a jump the same way path-navigated does, but may be called from
+ * any thread by someone holding a reference on the engine. The jumps are
+ * taken in on the main loop in batches.
+ */
+G_MODULE_EXPORT void
+navigation_engine_push (NavigationEngine *engine,
+                        const gchar      *from_file_path,
+                        gint              from_line_number,
+                        const gchar      *to_file_path,
+                        gint              to_line_number)
+{
+  NavigationEnginePrivate *priv;
+  
+  g_return_if_fail (IS_NAVIGATION_ENGINE (engine));
+  g_return_if_fail (from_file_path != NULL && to_file_path != NULL);
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  navigation_ingest_push (priv->ingest, from_file_path, from_line_number, 
+                          to_file_path, to_line_number);
+}
+
+/*
+ * Returns a reference on the snapshot of the current epoch, made on first
+ * request and shared until the history changes. Call on the main thread;
+ * the snapshot itself can then go to any thread.
+ */
+G_MODULE_EXPORT NavigationSnapshot*
+navigation_engine_get_snapshot (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  /* edits only move anchored lines, so they are checked here rather than
+     dropping the snapshot on every keystroke */
+  if (priv->snapshot != NULL && !navigation_snapshot_is_current (priv->snapshot, priv->history))
+    bump_epoch (engine);
+  
+  if (priv->snapshot == NULL)
+    priv->snapshot = navigation_snapshot_new (priv->history, priv->epoch);
+  
+  return navigation_snapshot_ref (priv->snapshot);
+}
+
+static gboolean
+open_document (NavigationEngine *engine, 
+               const gchar      *file_path,
+               gint              line_number)
+{
+  NavigationEnginePrivate *priv;
+  gboolean result;
+  gint64 started;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  NAVIGATION_PROBE (document__select__begin, file_path, line_number);
+  started = g_get_monotonic_time ();
+  result = codeslayer_select_document_by_file_path (priv->codeslayer, file_path, line_number);
+  navigation_stats_record (priv->stats, NAVIGATION_STAT_SELECT_DOCUMENT, started);
+  NAVIGATION_PROBE (document__select__end, file_path, line_number);
+  
+  return result;
+}
+
+/*
+ * Nodes in open files follow their marks. For the rest the file may have
+ * changed since, so the line is looked for near where it used to be.
+ */
+static gboolean
+relocate_node (NavigationNode *node)
+{
+  guint32 fingerprint;
+  gint line_number;
+  
+  fingerprint = navigation_node_get_fingerprint (node);
+  if (fingerprint == 0 || navigation_node_is_anchored (node))
+    return FALSE;
+  
+  line_number = navigation_fingerprint_locate (navigation_node_get_file_path (node), 
+                                               navigation_node_get_line_number (node), 
+                                               fingerprint);
+  if (line_number <= 0 || line_number == navigation_node_get_line_number (node))
+    return FALSE;
+
+  navigation_node_set_line_number (node, line_number);
+  return TRUE;
+}
+
+static gboolean
+select_document (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  NavigationNode *node;
+  const gchar *file_path;
+  gint line_number;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  node = navigation_history_get_current (priv->history);
+  if (node == NULL)
+    return FALSE;
+  
+  if (relocate_node (node))
+    bump_epoch (engine);
+  
+  file_path = navigation_node_get_file_path (node);
+  line_number = navigation_node_get_line_number (node);
+  
+  return open_document (engine, file_path, line_number);
+}
+
+static void
+cancel_select_document (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->select_id != 0)
+    {
+      g_source_remove (priv->select_id);
+      priv->select_id = 0;
+    }
+}
+
+static gboolean
+select_document_timeout (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  priv->select_id = 0;
+  
+  if (!select_document (engine))
+    {
+      mark_missing (engine, navigation_history_get_current (priv->history));
+      schedule_refresh (engine);
+    }
+  
+  return FALSE;
+}
+
+/*
+ * Walking back or forward moves the position right away, but the document is
+ * only opened once the key presses stop for select_delay milliseconds, so
+ * holding Alt+Left does not load every document along the way.
+ */
+static void
+schedule_select_document (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  guint select_delay;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  cancel_select_document (engine);
+  
+  select_delay = navigation_settings_get_select_delay (priv->settings);
+  
+  if (select_delay == 0)
+    {
+      select_document_timeout (engine);
+      return;
+    }
+  
+  priv->select_id = g_timeout_add (select_delay, 
+                                   (GSourceFunc) select_document_timeout, engine);
+}
+
+/*
+ * The next position from position in the direction of step whose file is
+ * not known to be gone, or -1 when there is none.
+ */
+static gint
+find_live_position (NavigationEngine *engine,
+                    gint              position,
+                    gint              step)
+{
+  NavigationEnginePrivate *priv;
+  gint length;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  length = navigation_history_get_length (priv->history);
+  
+  for (position += step; position >= 0 && position < length; position += step)
+    {
+      NavigationNode *node;
+      node = navigation_history_get (priv->history, position);
+      if (!navigation_path_get_missing (navigation_node_get_path (node)))
+        return position;
+    }
+  
+  return -1;
+}
+
+static gboolean
+prefetch_neighbours (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  const gchar *file_paths[3];
+  gint position;
+  gint step;
+  guint count = 0;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  priv->prefetch_id = 0;
+  
+  for (step = -1; step <= 1; step += 2)
+    {
+      position = find_live_position (engine, navigation_history_get_position (priv->history), step);
+      if (position >= 0)
+        file_paths[count++] = navigation_node_get_file_path (navigation_history_get (priv->history, position));
+    }
+  
+  file_paths[count] = NULL;
+  navigation_prefetcher_warm (priv->prefetcher, file_paths);
+  
+  return FALSE;
+}
+
+/*
+ * Once the position settles, the entries either side of it are read into
+ * the page cache so the next step back or forward opens a warm file.
+ */
+static void
+schedule_prefetch (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->prefetcher == NULL || priv->prefetch_id != 0)
+    return;
+  
+  priv->prefetch_id = g_idle_add_full (G_PRIORITY_LOW, 
+                                       (GSourceFunc) prefetch_neighbours, engine, NULL);
+}
+
+static void
+previous_action (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  gint position;
+  gint64 started;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->history == NULL)
+    return;
+  
+  started = g_get_monotonic_time ();
+  
+  position = find_live_position (engine, navigation_history_get_position (priv->history), -1);
+  
+  if (position >= 0)
+    {
+      navigation_history_set_position (priv->history, position);
+      log_position (engine);
+      schedule_refresh (engine);
+      schedule_select_document (engine);
+      schedule_prefetch (engine);
+    }
+  
+  navigation_stats_record (priv->stats, NAVIGATION_STAT_PREVIOUS, started);
+}
+
+static void
+next_action (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  gint position;
+  gint64 started;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->history == NULL)
+    return;
+  
+  started = g_get_monotonic_time ();
+  
+  position = find_live_position (engine, navigation_history_get_position (priv->history), 1);
+  
+  if (position >= 0)
+    {
+      navigation_history_set_position (priv->history, position);
+      log_position (engine);
+      schedule_refresh (engine);
+      schedule_select_document (engine);
+      schedule_prefetch (engine);
+    }
+  
+  navigation_stats_record (priv->stats, NAVIGATION_STAT_NEXT, started);
+}
+
+static void
+select_position_action (NavigationEngine *engine, 
+                        gint              position)
+{
+  NavigationEnginePrivate *priv;
+  gint64 started;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (position < 0 || position >= (gint) navigation_history_get_length (priv->history))
+    return;
+  
+  started = g_get_monotonic_time ();
+  
+  cancel_select_document (engine);
+  
+  navigation_history_set_position (priv->history, position);
+  log_position (engine);
+  
+  if (!select_document (engine))
+    mark_missing (engine, navigation_history_get_current (priv->history));
+  
+  schedule_refresh (engine);
+  schedule_prefetch (engine);
+  
+  navigation_stats_record (priv->stats, NAVIGATION_STAT_SELECT_POSITION, started);
+}
+
+/*
+ * Jumping to a frequent location is left to CodeSlayer, which reports it back
+ * through path-navigated like any other jump. A location that can no longer
+ * be opened is dropped from the index.
+ */
+static void
+select_location_action (NavigationEngine *engine, 
+                        gchar            *file_path,
+                        gint              line_number)
+{
+  NavigationEnginePrivate *priv;
+  NavigationPath *path;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  cancel_select_document (engine);
+  
+  if (open_document (engine, file_path, line_number))
+    return;
+  
+  path = navigation_path_pool_lookup (priv->path_pool, file_path);
+  if (path != NULL)
+    {
+      navigation_hotspots_remove (priv->hotspots, path, line_number);
+      schedule_refresh (engine);
+    }
+}
+
+static void
+switch_branch (NavigationEngine *engine,
+               gint              direction)
+{
+  NavigationEnginePrivate *priv;
+  gint position;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (priv->history == NULL)
+    return;
+  
+  position = navigation_history_get_position (priv->history);
+  
+  if (!navigation_history_switch_branch (priv->history, direction))
+    return;
+  
+  mark_trail_changed (engine, position + 1);
+  
+  if (priv->journal != NULL)
+    navigation_journal_switch_branch (priv->journal, direction);
+  
+  schedule_refresh (engine);
+  schedule_prefetch (engine);
+}
+
+static void
+previous_branch_action (NavigationEngine *engine)
+{
+  switch_branch (engine, -1);
+}
+
+static void
+next_branch_action (NavigationEngine *engine)
+{
+  switch_branch (engine, 1);
+}
+
+/*
+ * A document that could not be opened marks its file as gone rather than
+ * wiping the history. The validator then checks, and clears the mark again
+ * if the file is in fact still there.
+ */
+static void
+mark_missing (NavigationEngine *engine,
+              NavigationNode   *node)
+{
+  NavigationEnginePrivate *priv;
+  NavigationPath *path;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (node == NULL)
+    return;
+  
+  path = navigation_node_get_path (node);
+  navigation_path_set_missing (path, TRUE);
+  bump_epoch (engine);
+  
+  if (priv->validator != NULL)
+    navigation_validator_check (priv->validator, path);
+}
+
+/*
+ * The restored entries count as visits at the time they were made, so the
+ * frequent locations survive a restart along with the history.
+ */
+static void
+add_restored_hotspots (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  guint64 next_id;
+  guint64 id;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  next_id = navigation_history_get_next_id (priv->history);
+  
+  for (id = navigation_history_get_first_id (priv->history); id < next_id; id++)
+    {
+      NavigationNode *node;
+      node = navigation_history_lookup (priv->history, id);
+      /* only destinations count as visits, as they do live */
+      if (navigation_node_is_origin (node))
+        continue;
+      navigation_hotspots_visit (priv->hotspots, navigation_node_get_path (node), 
+                                 navigation_node_get_line_number (node), 
+                                 navigation_node_get_timestamp (node));
+    }
+}
+
+static gdouble
+elapsed (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  return (g_get_monotonic_time () - priv->started) / 1000.0;
+}
+
+static void
+journal_loaded (NavigationJournal *journal,
+                GAsyncResult      *result,
+                NavigationEngine  *engine)
+{
+  NavigationEnginePrivate *priv;
+  GError *error = NULL;
+
+  /* the engine is already gone */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (!navigation_journal_load_finish (journal, result, priv->history, priv->path_pool, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("navigation: unable to load history: %s", error->message);
+      g_error_free (error);
+    }
+  
+  g_debug ("navigation: history restored %.1f ms after activation", elapsed (engine));
+  
+  add_restored_hotspots (engine);
+  finish_loading (engine);
+}
+
+/*
+ * The journal is mapped and decoded off the main loop. Anything navigated to
+ * in the meantime is held back and applied on top of the restored history.
+ */
+static void
+load_journal (NavigationEngine *engine)
 {
-  CodeSlayer *codeslayer;
-  GtkWidget  *pane;
-  gulong      path_navigated_id;
-  GList      *path;
-  gint        position;
-};
+  NavigationEnginePrivate *priv;
+  gchar *folder_path;
+  gchar *file_path;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
 
-G_DEFINE_TYPE (NavigationEngine, navigation_engine, G_TYPE_OBJECT)
+  folder_path = codeslayer_get_plugins_config_folder_path (priv->codeslayer);
+  
+  /* a project's journal is named after a hash of its folder path */
+  if (*priv->partition->key == '\0')
+    {
+      file_path = codeslayer_utils_get_file_path (folder_path, JOURNAL_FILE);
+    }
+  else
+    {
+      gchar *checksum;
+      gchar *file_name;
+      checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, priv->partition->key, -1);
+      file_name = g_strdup_printf (PARTITION_JOURNAL_FILE, checksum);
+      file_path = codeslayer_utils_get_file_path (folder_path, file_name);
+      g_free (checksum);
+      g_free (file_name);
+    }
+  
+  priv->journal = navigation_journal_new (file_path);
+  priv->partition->journal = priv->journal;
+  
+  if (priv->load_cancellable == NULL)
+    priv->load_cancellable = g_cancellable_new ();
+  priv->loading = TRUE;
+  
+  navigation_journal_load_async (priv->journal, priv->load_cancellable, 
+                                 (GAsyncReadyCallback) journal_loaded, engine);
+
+  g_free (folder_path);
+  g_free (file_path);
+}
 
+/*
+ * Everything that depends on the settings waits for them here, which is why
+ * the history does not exist until then.
+ */
 static void
-navigation_engine_class_init (NavigationEngineClass *klass)
+settings_loaded (NavigationSettings *settings,
+                 GAsyncResult       *result,
+                 NavigationEngine   *engine)
 {
-  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
-  gobject_class->finalize = (GObjectFinalizeFunc) navigation_engine_finalize;
-  g_type_class_add_private (klass, sizeof (NavigationEnginePrivate));
+  NavigationEnginePrivate *priv;
+  GError *error = NULL;
+
+  /* the engine is already gone */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+  
+  if (!navigation_settings_load_finish (settings, result, &error))
+    {
+      g_warning ("navigation: unable to load settings: %s", error->message);
+      g_error_free (error);
+    }
+  
+  g_debug ("navigation: settings loaded %.1f ms after activation", elapsed (engine));
+  
+  priv->partitions = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, 
+                                            (GDestroyNotify) partition_free);
+  priv->partition = add_partition (engine, "");
+  priv->history = priv->partition->history;
+  
+  update_validator (engine);
+  update_prefetcher (engine);
+  update_pane (engine);
+  
+  /* persist_history is only read here, the rest follow edits to the file */
+  g_signal_connect_swapped (G_OBJECT (settings), "changed::" NAVIGATION_SETTINGS_SHOW_SIDE_PANE, 
+                            G_CALLBACK (update_pane), engine);
+  g_signal_connect_swapped (G_OBJECT (settings), "changed::" NAVIGATION_SETTINGS_HISTORY_CAPACITY, 
+                            G_CALLBACK (update_history_capacity), engine);
+  g_signal_connect_swapped (G_OBJECT (settings), "changed::" NAVIGATION_SETTINGS_VALIDATE_FILES, 
+                            G_CALLBACK (update_validator), engine);
+  g_signal_connect_swapped (G_OBJECT (settings), "changed::" NAVIGATION_SETTINGS_PREFETCH_BUDGET, 
+                            G_CALLBACK (update_prefetcher), engine);
+  
+  if (navigation_settings_get_persist_history (settings))
+    load_journal (engine);
+  else
+    finish_loading (engine);
 }
 
 static void
-navigation_engine_init (NavigationEngine *engine) 
+update_history_capacity (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
+  GHashTableIter iter;
+  Partition *partition;
+  guint capacity;
+  
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-  priv->path = NULL;
-  priv->pane = NULL;
+  
+  capacity = navigation_settings_get_history_capacity (priv->settings);
+  
+  g_hash_table_iter_init (&iter, priv->partitions);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &partition))
+    navigation_history_set_capacity (partition->history, capacity);
+  
+  schedule_refresh (engine);
 }
 
 static void
-navigation_engine_finalize (NavigationEngine *engine)
+update_validator (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  if (priv->pane != NULL)
-    codeslayer_remove_from_side_pane (priv->codeslayer, priv->pane);
-
-  g_signal_handler_disconnect (priv->codeslayer, priv->path_navigated_id);
-
-  g_list_foreach (priv->path, (GFunc) g_object_unref, NULL);
+  if (!navigation_settings_get_validate_files (priv->settings))
+    {
+      g_clear_object (&priv->validator);
+      return;
+    }
   
-  if (priv->path != NULL)
-    g_list_free (priv->path);
+  if (priv->validator != NULL)
+    return;
   
-  G_OBJECT_CLASS (navigation_engine_parent_class)->finalize (G_OBJECT (engine));
+  priv->validator = navigation_validator_new (priv->path_pool);
+  g_signal_connect_swapped (G_OBJECT (priv->validator), "changed", 
+                            G_CALLBACK (schedule_refresh), engine);
 }
 
-NavigationEngine*
-navigation_engine_new (CodeSlayer *codeslayer, 
-                       GtkWidget  *menu)
+static void
+update_prefetcher (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
-  NavigationEngine *engine;
-
-  engine = NAVIGATION_ENGINE (g_object_new (navigation_engine_get_type (), NULL));
+  guint budget;
+  
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-
-  priv->codeslayer = codeslayer;
   
-  add_pane (engine);
+  if (priv->prefetch_id != 0)
+    {
+      g_source_remove (priv->prefetch_id);
+      priv->prefetch_id = 0;
+    }
   
-  g_signal_connect_swapped (G_OBJECT (menu), "previous", 
-                            G_CALLBACK (previous_action), engine);
+  g_clear_object (&priv->prefetcher);
   
-  g_signal_connect_swapped (G_OBJECT (menu), "next", 
-                            G_CALLBACK (next_action), engine);
-
-  priv->path_navigated_id = g_signal_connect_swapped (G_OBJECT (codeslayer), "path-navigated", 
-                                                        G_CALLBACK (path_navigated_action), engine);
-                                                      
-  return engine;
+  budget = navigation_settings_get_prefetch_budget (priv->settings);
+  if (budget > 0)
+    priv->prefetcher = navigation_prefetcher_new (budget * (guint64) 1024);
 }
 
-static NavigationNode*
-create_node (gchar *file_path,
-             gint   line_number)
+/*
+ * Activation only starts reading navigation.conf. Jumps made before it and
+ * the journal are in are queued up, the same as while the journal loads.
+ */
+static void
+load_settings (NavigationEngine *engine)
 {
-  NavigationNode *node;
-  node = navigation_node_new ();
-  navigation_node_set_file_path (node, file_path); 
-  navigation_node_set_line_number (node, line_number); 
-  return node;
+  NavigationEnginePrivate *priv;
+  gchar *folder_path;
+  gchar *file_path;
+  
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
+
+  folder_path = codeslayer_get_plugins_config_folder_path (priv->codeslayer);
+  file_path = codeslayer_utils_get_file_path (folder_path, CONFIG_FILE);
+  
+  priv->settings = navigation_settings_new (file_path);
+  priv->load_cancellable = g_cancellable_new ();
+  priv->loading = TRUE;
+  
+  navigation_settings_load_async (priv->settings, priv->load_cancellable, 
+                                  (GAsyncReadyCallback) settings_loaded, engine);
+
+  g_free (folder_path);
+  g_free (file_path);
 }
 
 static void
-clear_forward_positions (NavigationEngine *engine)
+finish_loading (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
-  gint length;
-
+  DeferredNavigation *deferred;
+  
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-  length = g_list_length (priv->path);
   
-  while (priv->position < length - 1)
+  g_clear_object (&priv->load_cancellable);
+  priv->loading = FALSE;
+
+  /* stops early if one of them starts another partition loading */
+  while (!priv->loading && (deferred = g_queue_pop_head (priv->deferred)) != NULL)
     {
-      NavigationNode *node = g_list_nth_data (priv->path, length - 1);
-      priv->path = g_list_remove (priv->path, node);
-      g_object_unref (node);
-      length = g_list_length (priv->path);
+      path_navigated_action (engine, deferred->from_file_path, deferred->from_line_number, 
+                             deferred->to_file_path, deferred->to_line_number);
+      deferred_navigation_free (deferred);
     }
+
+  anchor_nodes (engine, NULL);
+  schedule_refresh (engine);
+  schedule_prefetch (engine);
 }
 
 static void
-path_navigated_action (NavigationEngine *engine,
-                       gchar            *from_file_path,
-                       gint              from_line_number,
-                       gchar            *to_file_path,
-                       gint              to_line_number)
+anchor_history (NavigationEngine  *engine,
+                NavigationHistory *history,
+                const gchar       *file_path)
 {
   NavigationEnginePrivate *priv;
+  guint64 next_id;
+  guint64 id;
+  
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  if (priv->path == NULL)
-    {
-      priv->path = g_list_append (priv->path, create_node (from_file_path, from_line_number));
-      priv->position = 0;
-    }
-  else
+  next_id = navigation_history_get_next_id (history);
+
+  for (id = navigation_history_get_first_id (history); id < next_id; id++)
     {
-      NavigationNode *curr_node;
-      NavigationNode *from_node;
-    
-      clear_forward_positions (engine);
+      NavigationNode *node;
+      const gchar *node_file_path;
+      GtkTextBuffer *buffer;
       
-      curr_node = g_list_nth_data (priv->path, priv->position);      
-      from_node = create_node (from_file_path, from_line_number);
+      node = navigation_history_lookup (history, id);
+      node_file_path = navigation_node_get_file_path (node);
+
+      if (navigation_node_is_anchored (node) ||
+          (file_path != NULL && g_strcmp0 (node_file_path, file_path) != 0))
+        continue;
       
-      if (!navigation_node_equals (curr_node, from_node))
-        {
-          priv->path = g_list_append (priv->path, from_node);
-          priv->position = g_list_length (priv->path) - 1;
-        }
-      else
-        {
-          g_object_unref (from_node);        
-        }
+      buffer = g_hash_table_lookup (priv->buffers, node_file_path);
+      if (buffer != NULL)
+        navigation_node_anchor (node, buffer);
     }
+}
+
+/*
+ * Anchors the entries for file_path, or for every open file when it is NULL,
+ * to marks in their buffers. Partitions other than the current one are
+ * anchored too, so they are still right when switched back to.
+ */
+static void
+anchor_nodes (NavigationEngine *engine,
+              const gchar      *file_path)
+{
+  NavigationEnginePrivate *priv;
+  GHashTableIter iter;
+  gpointer value;
   
-  priv->path = g_list_append (priv->path, create_node (to_file_path, to_line_number));
-  priv->position = g_list_length (priv->path) - 1;
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  while (g_list_length (priv->path) > 25)
-    {
-      NavigationNode *first_node;
-      first_node = g_list_nth_data (priv->path, 0);
-      priv->path = g_list_remove (priv->path, first_node);
-      priv->position = g_list_length (priv->path) - 1;
-    }
-
-  if (priv->pane != NULL)
-    navigation_pane_refresh_path (NAVIGATION_PANE (priv->pane), priv->path, priv->position);
+  if (priv->partitions == NULL)
+    return;
+  
+  g_hash_table_iter_init (&iter, priv->partitions);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    anchor_history (engine, ((Partition *) value)->history, file_path);
 }
 
 static void
-previous_action (NavigationEngine *engine)
+track_editor (NavigationEngine *engine,
+              CodeSlayerEditor *editor)
 {
   NavigationEnginePrivate *priv;
-  NavigationNode *node;
+  CodeSlayerDocument *document;
   const gchar *file_path;
-  gint line_number;
+  GtkTextBuffer *buffer;
   
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  if (priv->position <= 0)
-    return;
+  document = codeslayer_editor_get_document (editor);
+  file_path = codeslayer_document_get_file_path (document);
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (editor));
   
-  priv->position = priv->position - 1;
+  if (file_path == NULL || g_hash_table_lookup (priv->buffers, file_path) == buffer)
+    return;
   
-  node = g_list_nth_data (priv->path, priv->position);
+  g_hash_table_insert (priv->buffers, g_strdup (file_path), buffer);
+  g_object_weak_ref (G_OBJECT (buffer), (GWeakNotify) buffer_finalized, engine);
   
-  file_path = navigation_node_get_file_path (node);
-  line_number = navigation_node_get_line_number (node);
+  anchor_nodes (engine, file_path);
+}
+
+static void
+release_history (NavigationHistory *history,
+                 GObject           *buffer)
+{
+  guint64 next_id;
+  guint64 id;
   
-  codeslayer_select_document_by_file_path (priv->codeslayer, file_path, line_number);
+  next_id = navigation_history_get_next_id (history);
 
-  if (priv->pane != NULL)
-    navigation_pane_refresh_path (NAVIGATION_PANE (priv->pane), priv->path, priv->position);
+  for (id = navigation_history_get_first_id (history); id < next_id; id++)
+    {
+      NavigationNode *node = navigation_history_lookup (history, id);
+      if ((GObject *) navigation_node_get_buffer (node) == buffer)
+        {
+          gint line_number = navigation_node_get_line_number (node);
+          navigation_node_set_fingerprint (node, navigation_fingerprint_from_buffer (GTK_TEXT_BUFFER (buffer), 
+                                                                                     line_number));
+          navigation_node_release_anchor (node);
+        }
+    }
 }
 
+/*
+ * The editor was closed. The buffer contents are still there while weak
+ * references are notified, so the marks can give up their lines first.
+ */
 static void
-next_action (NavigationEngine *engine)
+buffer_finalized (NavigationEngine *engine,
+                  GObject          *buffer)
 {
   NavigationEnginePrivate *priv;
-  NavigationNode *node;
-  const gchar *file_path;
-  gint line_number;
-  gint length;
+  GHashTableIter iter;
+  gpointer value;
   
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  length = g_list_length (priv->path);
-  
-  if (priv->position >= length - 1)
-    return;
-  
-  priv->position = priv->position + 1;
+  if (priv->partitions != NULL)
+    {
+      g_hash_table_iter_init (&iter, priv->partitions);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        release_history (((Partition *) value)->history, buffer);
+    }
   
-  node = g_list_nth_data (priv->path, priv->position);
+  g_hash_table_iter_init (&iter, priv->buffers);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    if (value == buffer)
+      g_hash_table_iter_remove (&iter);
+}
+
+/*
+ * Adds or removes the pane to match the show_side_pane setting, whether it
+ * was changed from the dialog or in the file.
+ */
+static void
+update_pane (NavigationEngine *engine)
+{
+  NavigationEnginePrivate *priv;
+  gboolean show;
   
-  file_path = navigation_node_get_file_path (node);
-  line_number = navigation_node_get_line_number (node);
+  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  if (codeslayer_select_document_by_file_path (priv->codeslayer, file_path, line_number))
+  show = navigation_settings_get_show_side_pane (priv->settings);
+
+  if (show && priv->pane == NULL)
     {
-      if (priv->pane != NULL)
-        navigation_pane_refresh_path (NAVIGATION_PANE (priv->pane), priv->path, priv->position);
+      priv->pane = navigation_pane_new (priv->codeslayer, priv->history, priv->hotspots);
+      codeslayer_add_to_side_pane (priv->codeslayer, priv->pane, _("Navigation"));
+      g_signal_connect_swapped (G_OBJECT (priv->pane), "select-position", 
+                                G_CALLBACK (select_position_action), engine);
+      g_signal_connect_swapped (G_OBJECT (priv->pane), "select-location", 
+                                G_CALLBACK (select_location_action), engine);
     }
-  else
+  else if (!show && priv->pane != NULL)
     {
-      clear_path (engine);    
+      codeslayer_remove_from_side_pane (priv->codeslayer, priv->pane);
+      priv->pane = NULL;
     }
 }
 
+/*
+ * Fills the dialog with the histograms, under a note when there is one.
+ */
 static void
-select_position_action (NavigationEngine *engine, 
-                        gint              position)
+show_stats (NavigationEngine *engine, 
+            const gchar      *note)
 {
   NavigationEnginePrivate *priv;
-  NavigationNode *node;
-  const gchar *file_path;
-  gint line_number;
+  gchar *stats;
+  gchar *text;
   
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
-  priv->position = position;
-  
-  node = g_list_nth_data (priv->path, priv->position);
+  if (priv->stats_buffer == NULL)
+    return;
   
-  file_path = navigation_node_get_file_path (node);
-  line_number = navigation_node_get_line_number (node);
+  stats = navigation_stats_to_string (priv->stats);
   
-  if (codeslayer_select_document_by_file_path (priv->codeslayer, file_path, line_number))
-    {
-      if (priv->pane != NULL)
-        navigation_pane_refresh_path (NAVIGATION_PANE (priv->pane), priv->path, priv->position);
-    }
+  if (note != NULL)
+    text = g_strconcat (note, "\n\n", stats, NULL);
   else
-    {
-      clear_path (engine);    
-    }
+    text = g_strdup (stats);
+  
+  gtk_text_buffer_set_text (priv->stats_buffer, text, -1);
+  
+  g_free (stats);
+  g_free (text);
 }
 
 static void
-clear_path (NavigationEngine *engine)
+reset_stats_action (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-  g_list_foreach (priv->path, (GFunc) g_object_unref, NULL);
-  g_list_free (priv->path);
-  priv->path = NULL;
-  priv->position = 0;
+  navigation_stats_reset (priv->stats);
+  show_stats (engine, NULL);
 }
 
-static gboolean
-show_pane (NavigationEngine *engine)
+static void
+save_stats_action (NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
-  GKeyFile *key_file;
+  GError *error = NULL;
   gchar *folder_path;
   gchar *file_path;
-  gboolean result;
+  gchar *note;
   
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-
+  
   folder_path = codeslayer_get_plugins_config_folder_path (priv->codeslayer);
+  file_path = codeslayer_utils_get_file_path (folder_path, STATS_FILE);
   
-  file_path = codeslayer_utils_get_file_path (folder_path, "navigation.conf");
+  if (navigation_stats_dump (priv->stats, file_path, &error))
+    {
+      note = g_strdup_printf (_("Saved to %s"), file_path);
+    }
+  else
+    {
+      note = g_strdup_printf (_("Unable to save: %s"), error->message);
+      g_error_free (error);
+    }
   
-  key_file = codeslayer_utils_get_key_file (file_path);
+  show_stats (engine, note);
   
-  if (g_key_file_has_key (key_file, MAIN, SHOW_SIDE_PANE, NULL))
-    result = g_key_file_get_boolean (key_file, MAIN, SHOW_SIDE_PANE, NULL);
-
   g_free (folder_path);
   g_free (file_path);
-  g_key_file_free (key_file);
-
-  return result;
-}
-
-static void
-add_pane (NavigationEngine *engine)
-{
-  NavigationEnginePrivate *priv;
-  priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-
-  if (show_pane (engine))
-    {
-      priv->pane = navigation_pane_new (priv->codeslayer);
-      codeslayer_add_to_side_pane (priv->codeslayer, priv->pane, _("Navigation"));
-      g_signal_connect_swapped (G_OBJECT (priv->pane), "select-position", 
-                                G_CALLBACK (select_position_action), engine);
-    }                            
+  g_free (note);
 }
 
 void
@@ -350,6 +1811,13 @@ navigation_engine_open_dialog (NavigationEngine *engine)
   GtkWidget *content_area;
   GtkWidget *hbox;
   GtkWidget *toggle_button;
+  GtkWidget *expander;
+  GtkWidget *vbox;
+  GtkWidget *scrolled_window;
+  GtkWidget *text_view;
+  GtkWidget *button_box;
+  GtkWidget *button;
+  PangoFontDescription *font;
 
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
   
@@ -371,7 +1839,7 @@ navigation_engine_open_dialog (NavigationEngine *engine)
   toggle_button = gtk_check_button_new_with_label (_("Show Navigation Pane?"));
   
   gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (toggle_button),
-                                show_pane (engine));
+                                navigation_settings_get_show_side_pane (priv->settings));
   
   g_signal_connect (G_OBJECT (toggle_button), "toggled", 
                     G_CALLBACK (toggle_dialog_action), engine);
@@ -380,10 +1848,51 @@ navigation_engine_open_dialog (NavigationEngine *engine)
   
   gtk_container_add (GTK_CONTAINER (content_area), hbox);
   
+  text_view = gtk_text_view_new ();
+  gtk_text_view_set_editable (GTK_TEXT_VIEW (text_view), FALSE);
+  gtk_text_view_set_cursor_visible (GTK_TEXT_VIEW (text_view), FALSE);
+  font = pango_font_description_from_string ("monospace");
+  gtk_widget_override_font (text_view, font);
+  pango_font_description_free (font);
+  
+  priv->stats_buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (text_view));
+  show_stats (engine, NULL);
+  
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window),
+                                  GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_size_request (scrolled_window, 480, 240);
+  gtk_container_add (GTK_CONTAINER (scrolled_window), text_view);
+  
+  button_box = gtk_button_box_new (GTK_ORIENTATION_HORIZONTAL);
+  gtk_button_box_set_layout (GTK_BUTTON_BOX (button_box), GTK_BUTTONBOX_END);
+  
+  button = gtk_button_new_with_label (_("Reset"));
+  g_signal_connect_swapped (G_OBJECT (button), "clicked", 
+                            G_CALLBACK (reset_stats_action), engine);
+  gtk_container_add (GTK_CONTAINER (button_box), button);
+  
+  button = gtk_button_new_from_stock (GTK_STOCK_SAVE);
+  g_signal_connect_swapped (G_OBJECT (button), "clicked", 
+                            G_CALLBACK (save_stats_action), engine);
+  gtk_container_add (GTK_CONTAINER (button_box), button);
+  
+  vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 4);
+  gtk_box_pack_start (GTK_BOX (vbox), scrolled_window, TRUE, TRUE, 0);
+  gtk_box_pack_start (GTK_BOX (vbox), button_box, FALSE, FALSE, 0);
+  
+  expander = gtk_expander_new (_("Latency"));
+  gtk_container_set_border_width (GTK_CONTAINER (expander), 20);
+  gtk_container_add (GTK_CONTAINER (expander), vbox);
+  gtk_box_pack_start (GTK_BOX (content_area), expander, TRUE, TRUE, 0);
+  
   gtk_widget_show_all (hbox);
+  gtk_widget_show_all (expander);
 
   gtk_dialog_run (GTK_DIALOG (dialog));
   gtk_widget_destroy (dialog);
+  
+  priv->stats_buffer = NULL;
 }
 
 static void 
@@ -391,40 +1900,7 @@ toggle_dialog_action (GtkToggleButton  *toggle_button,
                       NavigationEngine *engine)
 {
   NavigationEnginePrivate *priv;
-  GKeyFile *key_file;
-  gboolean active;
-  gchar *folder_path;
-  gchar *file_path;
-  
   priv = NAVIGATION_ENGINE_GET_PRIVATE (engine);
-  
-  active = gtk_toggle_button_get_active (toggle_button);
-  
-  if (active && priv->pane == NULL)
-    {
-      priv->pane = navigation_pane_new (priv->codeslayer);
-      codeslayer_add_to_side_pane (priv->codeslayer, priv->pane, _("Navigation"));
-      g_signal_connect_swapped (G_OBJECT (priv->pane), "select-position", 
-                                G_CALLBACK (select_position_action), engine);
-      if (priv->path != NULL)
-        navigation_pane_refresh_path (NAVIGATION_PANE (priv->pane), priv->path, priv->position);                                
-    }
-  else if (!active && priv->pane != NULL)
-    {
-      codeslayer_remove_from_side_pane (priv->codeslayer, priv->pane);
-      priv->pane = NULL;
-    }
-    
-  folder_path = codeslayer_get_plugins_config_folder_path (priv->codeslayer);
-  file_path = codeslayer_utils_get_file_path (folder_path, "navigation.conf");
-  
-  key_file = codeslayer_utils_get_key_file (file_path);
-  
-  g_key_file_set_boolean (key_file, MAIN, SHOW_SIDE_PANE, active);
-  
-  codeslayer_utils_save_key_file (key_file, file_path);
-
-  g_free (folder_path);
-  g_free (file_path);
-  g_key_file_free (key_file);
+  navigation_settings_set_show_side_pane (priv->settings, 
+                                          gtk_toggle_button_get_active (toggle_button));
 }
@@ -21,6 +21,8 @@
 
 #include <gtk/gtk.h>
 #include <codeslayer/codeslayer.h>
+#include "navigation.h"
+#include "navigation-snapshot.h"
 
 G_BEGIN_DECLS
 
@@ -30,7 +32,6 @@ G_BEGIN_DECLS
 #define IS_NAVIGATION_ENGINE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_ENGINE_TYPE))
 #define IS_NAVIGATION_ENGINE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_ENGINE_TYPE))
 
-typedef struct _NavigationEngine NavigationEngine;
 typedef struct _NavigationEngineClass NavigationEngineClass;
 
 struct _NavigationEngine
@@ -45,10 +46,10 @@ struct _NavigationEngineClass
 
 GType navigation_engine_get_type (void) G_GNUC_CONST;
 
-NavigationEngine*  navigation_engine_new          (CodeSlayer       *codeslayer, 
-                                                   GtkWidget        *menu);
+NavigationEngine*    navigation_engine_new           (CodeSlayer       *codeslayer, 
+                                                     GtkWidget        *menu);
 
-void               navigation_engine_open_dialog  (NavigationEngine *engine);
+void                 navigation_engine_open_dialog   (NavigationEngine *engine);
 
 G_END_DECLS
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#include <string.h>
+#include "navigation-fingerprint.h"
+
+/* how far from the old line a moved line is looked for */
+#define WINDOW_LINES 256
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+static guint32
+hash_line (const gchar *text, 
+           gsize        length)
+{
+  const gchar *end;
+  guint32 hash;
+  
+  end = text + length;
+  
+  while (text < end && g_ascii_isspace (*text))
+    text++;
+  while (end > text && g_ascii_isspace (end[-1]))
+    end--;
+
+  hash = FNV_OFFSET;
+  for (; text < end; text++)
+    {
+      hash ^= (guint8) *text;
+      hash *= FNV_PRIME;
+    }
+
+  /* 0 stands for a line that is not there */
+  return hash != 0 ? hash : 1;
+}
+
+static guint32
+combine (guint32 previous, 
+         guint32 line, 
+         guint32 next)
+{
+  guint32 hash;
+  
+  hash = line ^ ((previous << 7) | (previous >> 25)) ^ ((next << 19) | (next >> 13));
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+
+  return hash != 0 ? hash : 1;
+}
+
+static guint32
+hash_buffer_line (GtkTextBuffer *buffer,
+                  gint           line,
+                  gint           line_count)
+{
+  GtkTextIter start;
+  GtkTextIter end;
+  guint32 hash;
+  gchar *text;
+  
+  if (line < 0 || line >= line_count)
+    return 0;
+  
+  gtk_text_buffer_get_iter_at_line (buffer, &start, line);
+  end = start;
+  if (!gtk_text_iter_ends_line (&end))
+    gtk_text_iter_forward_to_line_end (&end);
+  
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  hash = hash_line (text, strlen (text));
+  g_free (text);
+  
+  return hash;
+}
+
+guint32
+navigation_fingerprint_from_buffer (GtkTextBuffer *buffer,
+                                    gint           line_number)
+{
+  GtkTextIter iter;
+  gint line_count;
+  gint line;
+  
+  line_count = gtk_text_buffer_get_line_count (buffer);
+  
+  /* a buffer ending in a newline has an empty last line the file does not */
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  if (line_count > 1 && gtk_text_iter_starts_line (&iter))
+    line_count--;
+  
+  line = line_number - 1;
+  if (line < 0 || line >= line_count)
+    return 0;
+  
+  return combine (hash_buffer_line (buffer, line - 1, line_count),
+                  hash_buffer_line (buffer, line, line_count),
+                  hash_buffer_line (buffer, line + 1, line_count));
+}
+
+/*
+ * Hashes lines first to last of the file into hashes, leaving 0 for the
+ * ones that are not there. The lines before the window are only skipped
+ * over with memchr, which libc vectorises, and nothing past it is touched.
+ */
+static gboolean
+hash_file_lines (const gchar *file_path,
+                 gint         first,
+                 gint         last,
+                 guint32     *hashes)
+{
+  GMappedFile *mapped_file;
+  const gchar *data;
+  const gchar *end;
+  gint line;
+  
+  mapped_file = g_mapped_file_new (file_path, FALSE, NULL);
+  if (mapped_file == NULL)
+    return FALSE;
+  
+  memset (hashes, 0, (last - first + 1) * sizeof (guint32));
+
+  data = g_mapped_file_get_contents (mapped_file);
+  end = data + g_mapped_file_get_length (mapped_file);
+
+  for (line = 0; data < end && line <= last; line++)
+    {
+      const gchar *newline;
+      
+      newline = memchr (data, '\n', end - data);
+      if (newline == NULL)
+        newline = end;
+      
+      if (line >= first)
+        hashes[line - first] = hash_line (data, newline - data);
+      
+      data = newline + 1;
+    }
+  
+  g_mapped_file_unref (mapped_file);
+  
+  return TRUE;
+}
+
+guint32
+navigation_fingerprint_from_file (const gchar *file_path,
+                                  gint         line_number)
+{
+  guint32 hashes[3];
+  gint line;
+  
+  line = line_number - 1;
+  if (line < 0 || !hash_file_lines (file_path, line - 1, line + 1, hashes) || hashes[1] == 0)
+    return 0;
+  
+  return combine (hashes[0], hashes[1], hashes[2]);
+}
+
+/*
+ * Returns the line nearest to line_number whose fingerprint matches, or 0
+ * when the file can not be read or the content is no longer close by.
+ */
+gint
+navigation_fingerprint_locate (const gchar *file_path,
+                               gint         line_number,
+                               guint32      fingerprint)
+{
+  guint32 hashes[2 * WINDOW_LINES + 3];
+  gint distance;
+  gint first;
+  gint line;
+  
+  line = MAX (line_number, 1) - 1;
+  first = line - WINDOW_LINES - 1;
+
+  if (!hash_file_lines (file_path, first, line + WINDOW_LINES + 1, hashes))
+    return 0;
+  
+  for (distance = 0; distance <= WINDOW_LINES; distance++)
+    {
+      gint i;
+      
+      i = line - distance - first;
+      if (line - distance >= 0 && hashes[i] != 0 &&
+          combine (hashes[i - 1], hashes[i], hashes[i + 1]) == fingerprint)
+        return line - distance + 1;
+
+      i = line + distance - first;
+      if (distance > 0 && hashes[i] != 0 &&
+          combine (hashes[i - 1], hashes[i], hashes[i + 1]) == fingerprint)
+        return line + distance + 1;
+    }
+  
+  return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#ifndef __NAVIGATION_FINGERPRINT_H__
+#define __NAVIGATION_FINGERPRINT_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A 32 bit hash of a line together with the lines either side of it, with
+ * the whitespace at both ends of each line left out. It lets an entry find
+ * its line again after the file was changed while it was not open, by
+ * looking for the same hash within a bounded window around the old line.
+ * Zero means there is no fingerprint.
+ */
+
+guint32  navigation_fingerprint_from_buffer  (GtkTextBuffer *buffer,
+                                              gint           line_number);
+guint32  navigation_fingerprint_from_file    (const gchar   *file_path,
+                                              gint           line_number);
+gint     navigation_fingerprint_locate       (const gchar   *file_path,
+                                              gint           line_number,
+                                              guint32        fingerprint);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_FINGERPRINT_H__ */
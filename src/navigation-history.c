@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include "navigation-history.h"
+#include "navigation-node-private.h"
+#include "navigation-probes.h"
+
+typedef struct
+{
+  guint64 parent;
+  guint64 first_child;
+  guint64 next_sibling;
+  guint64 active_child;
+} NavigationLink;
+
+struct _NavigationHistory
+{
+  NavigationNode *nodes;
+  NavigationLink *links;
+  guint           capacity;
+  guint64         first_id;
+  guint64         next_id;
+  guint64        *trail;
+  guint           head;
+  guint           length;
+  gint            position;
+  guint64         offset;
+};
+
+#define NODE_SLOT(history, id) ((id) % (history)->capacity)
+#define TRAIL_SLOT(history, index) (((history)->head + (index)) % (history)->capacity)
+#define LINK(history, id) (&(history)->links[NODE_SLOT (history, id)])
+#define TRAIL_ID(history, index) ((history)->trail[TRAIL_SLOT (history, index)])
+
+NavigationHistory*
+navigation_history_new (guint capacity)
+{
+  NavigationHistory *history;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+
+  history = g_new0 (NavigationHistory, 1);
+  history->nodes = g_new0 (NavigationNode, capacity);
+  history->links = g_new0 (NavigationLink, capacity);
+  history->trail = g_new0 (guint64, capacity);
+  history->capacity = capacity;
+
+  return history;
+}
+
+void
+navigation_history_free (NavigationHistory *history)
+{
+  navigation_history_clear (history);
+  g_free (history->nodes);
+  g_free (history->links);
+  g_free (history->trail);
+  g_free (history);
+}
+
+static gboolean
+contains (NavigationHistory *history,
+          guint64            id)
+{
+  return id != NAVIGATION_HISTORY_NONE && id >= history->first_id && id < history->next_id;
+}
+
+guint
+navigation_history_get_capacity (NavigationHistory *history)
+{
+  return history->capacity;
+}
+
+/*
+ * The length, offset and position all refer to the trail.
+ */
+guint
+navigation_history_get_length (NavigationHistory *history)
+{
+  return history->length;
+}
+
+/*
+ * The number of entries ever evicted from the front of the trail, which is
+ * the absolute index of the entry at index 0. Consumers that apply changes
+ * lazily use it to tell how far the trail has moved since they last looked.
+ */
+guint64
+navigation_history_get_offset (NavigationHistory *history)
+{
+  return history->offset;
+}
+
+gint
+navigation_history_get_position (NavigationHistory *history)
+{
+  return history->position;
+}
+
+void
+navigation_history_set_position (NavigationHistory *history,
+                                 gint               position)
+{
+  g_return_if_fail (position >= 0 && position < (gint) history->length);
+  history->position = position;
+  NAVIGATION_PROBE_NODE (position__change, navigation_history_get_current (history));
+}
+
+NavigationNode*
+navigation_history_get (NavigationHistory *history,
+                        guint              index)
+{
+  if (index >= history->length)
+    return NULL;
+  return &history->nodes[NODE_SLOT (history, TRAIL_ID (history, index))];
+}
+
+NavigationNode*
+navigation_history_get_current (NavigationHistory *history)
+{
+  return navigation_history_get (history, history->position);
+}
+
+guint64
+navigation_history_get_id (NavigationHistory *history,
+                           guint              index)
+{
+  if (index >= history->length)
+    return NAVIGATION_HISTORY_NONE;
+  return TRAIL_ID (history, index);
+}
+
+/*
+ * The number of branches leaving the entry, more than one means there are
+ * forward entries off the trail.
+ */
+guint
+navigation_history_get_branch_count (NavigationHistory *history,
+                                     guint              index)
+{
+  guint64 child;
+  guint count = 0;
+
+  if (index >= history->length)
+    return 0;
+
+  for (child = LINK (history, TRAIL_ID (history, index))->first_child; 
+       child != NAVIGATION_HISTORY_NONE; 
+       child = LINK (history, child)->next_sibling)
+    count++;
+
+  return count;
+}
+
+guint64
+navigation_history_get_first_id (NavigationHistory *history)
+{
+  return history->first_id;
+}
+
+guint64
+navigation_history_get_next_id (NavigationHistory *history)
+{
+  return history->next_id;
+}
+
+NavigationNode*
+navigation_history_lookup (NavigationHistory *history,
+                           guint64            id)
+{
+  if (!contains (history, id))
+    return NULL;
+  return &history->nodes[NODE_SLOT (history, id)];
+}
+
+guint64
+navigation_history_get_parent (NavigationHistory *history,
+                               guint64            id)
+{
+  if (!contains (history, id))
+    return NAVIGATION_HISTORY_NONE;
+  return LINK (history, id)->parent;
+}
+
+guint64
+navigation_history_get_active_child (NavigationHistory *history,
+                                     guint64            id)
+{
+  if (!contains (history, id))
+    return NAVIGATION_HISTORY_NONE;
+  return LINK (history, id)->active_child;
+}
+
+guint64
+navigation_history_get_first_child (NavigationHistory *history,
+                                    guint64            id)
+{
+  if (!contains (history, id))
+    return NAVIGATION_HISTORY_NONE;
+  return LINK (history, id)->first_child;
+}
+
+/*
+ * The oldest node never has a parent, since its parent would be older still.
+ * Its children become roots, and if it starts the trail the trail moves up.
+ */
+static void
+evict_oldest (NavigationHistory *history)
+{
+  guint64 id;
+  guint64 child;
+
+  id = history->first_id;
+  
+  NAVIGATION_PROBE_NODE (history__evict, &history->nodes[NODE_SLOT (history, id)]);
+
+  if (history->length > 0 && TRAIL_ID (history, 0) == id)
+    {
+      history->head = (history->head + 1) % history->capacity;
+      history->length--;
+      history->offset++;
+      if (history->position > 0)
+        history->position--;
+    }
+
+  for (child = LINK (history, id)->first_child; 
+       child != NAVIGATION_HISTORY_NONE; 
+       child = LINK (history, child)->next_sibling)
+    LINK (history, child)->parent = NAVIGATION_HISTORY_NONE;
+
+  history->first_id++;
+}
+
+static guint64
+add_node (NavigationHistory *history,
+          guint64            parent,
+          NavigationPath    *path,
+          gint               line_number)
+{
+  NavigationLink *link;
+  guint64 id;
+
+  /* on a full history the slot being written is the evicted node, and
+     navigation_node_set takes the new path before dropping the old one */
+  if (history->next_id - history->first_id == history->capacity)
+    evict_oldest (history);
+
+  if (!contains (history, parent))
+    parent = NAVIGATION_HISTORY_NONE;
+
+  id = history->next_id++;
+  navigation_node_set (&history->nodes[NODE_SLOT (history, id)], path, line_number);
+
+  link = LINK (history, id);
+  link->parent = parent;
+  link->first_child = NAVIGATION_HISTORY_NONE;
+  link->next_sibling = NAVIGATION_HISTORY_NONE;
+  link->active_child = NAVIGATION_HISTORY_NONE;
+
+  if (parent != NAVIGATION_HISTORY_NONE)
+    {
+      NavigationLink *parent_link = LINK (history, parent);
+      link->next_sibling = parent_link->first_child;
+      parent_link->first_child = id;
+      parent_link->active_child = id;
+    }
+
+  return id;
+}
+
+static void
+extend_trail (NavigationHistory *history,
+              guint64            id)
+{
+  while (id != NAVIGATION_HISTORY_NONE)
+    {
+      history->trail[TRAIL_SLOT (history, history->length)] = id;
+      history->length++;
+      id = LINK (history, id)->active_child;
+    }
+}
+
+/*
+ * Moves the nodes into slabs of the new capacity. Shrinking evicts the
+ * oldest nodes until the rest fit, the same as pushing would have.
+ */
+void
+navigation_history_set_capacity (NavigationHistory *history,
+                                 guint              capacity)
+{
+  NavigationNode *nodes;
+  NavigationLink *links;
+  guint64 *trail;
+  guint64 id;
+  guint index;
+
+  g_return_if_fail (capacity > 0);
+
+  if (capacity == history->capacity)
+    return;
+
+  while (history->next_id - history->first_id > capacity)
+    {
+      navigation_node_clear (&history->nodes[NODE_SLOT (history, history->first_id)]);
+      evict_oldest (history);
+    }
+
+  nodes = g_new0 (NavigationNode, capacity);
+  links = g_new0 (NavigationLink, capacity);
+  trail = g_new0 (guint64, capacity);
+
+  /* the nodes hold their references and marks, so they move by value */
+  for (id = history->first_id; id < history->next_id; id++)
+    {
+      nodes[id % capacity] = history->nodes[NODE_SLOT (history, id)];
+      links[id % capacity] = *LINK (history, id);
+    }
+
+  for (index = 0; index < history->length; index++)
+    trail[index] = TRAIL_ID (history, index);
+
+  g_free (history->nodes);
+  g_free (history->links);
+  g_free (history->trail);
+
+  history->nodes = nodes;
+  history->links = links;
+  history->trail = trail;
+  history->capacity = capacity;
+  history->head = 0;
+}
+
+/*
+ * Adds a node under the current one and moves to it. Any entries forward of
+ * the position leave the trail but stay in the tree as another branch.
+ */
+NavigationNode*
+navigation_history_push (NavigationHistory *history,
+                         NavigationPath    *path,
+                         gint               line_number)
+{
+  guint64 parent = NAVIGATION_HISTORY_NONE;
+  guint64 id;
+
+  if (history->length > 0)
+    {
+      if (history->position + 1 < (gint) history->length)
+        NAVIGATION_PROBE_NODE (history__truncate, navigation_history_get (history, history->position + 1));
+      history->length = history->position + 1;
+      parent = TRAIL_ID (history, history->position);
+    }
+
+  id = add_node (history, parent, path, line_number);
+  NAVIGATION_PROBE (history__push, navigation_path_get_file_path (path), line_number);
+
+  history->trail[TRAIL_SLOT (history, history->length)] = id;
+  history->length++;
+  history->position = history->length - 1;
+
+  return &history->nodes[NODE_SLOT (history, id)];
+}
+
+/*
+ * Makes the next (direction > 0) or previous sibling branch under the current
+ * node the active one, so that walking forward follows it.
+ */
+gboolean
+navigation_history_switch_branch (NavigationHistory *history,
+                                  gint               direction)
+{
+  NavigationLink *link;
+  guint64 current;
+  guint64 branch;
+
+  if (history->length == 0)
+    return FALSE;
+
+  link = LINK (history, TRAIL_ID (history, history->position));
+  current = link->active_child;
+
+  if (current == NAVIGATION_HISTORY_NONE)
+    return FALSE;
+
+  if (direction > 0)
+    {
+      branch = LINK (history, current)->next_sibling;
+      if (branch == NAVIGATION_HISTORY_NONE)
+        branch = link->first_child;
+    }
+  else
+    {
+      guint64 child = link->first_child;
+      while (LINK (history, child)->next_sibling != current && 
+             LINK (history, child)->next_sibling != NAVIGATION_HISTORY_NONE)
+        child = LINK (history, child)->next_sibling;
+      branch = child;
+    }
+
+  if (branch == current)
+    return FALSE;
+
+  link->active_child = branch;
+
+  history->length = history->position + 1;
+  extend_trail (history, branch);
+
+  return TRUE;
+}
+
+void
+navigation_history_clear (NavigationHistory *history)
+{
+  guint64 id;
+
+  for (id = history->first_id; id < history->next_id; id++)
+    navigation_node_clear (&history->nodes[NODE_SLOT (history, id)]);
+
+  history->first_id = history->next_id;
+  history->head = 0;
+  history->length = 0;
+  history->position = 0;
+}
+
+/*
+ * Adds a node under parent, or as a root, without touching the trail. Used
+ * to rebuild a tree, after which navigation_history_set_trail settles the
+ * trail.
+ */
+NavigationNode*
+navigation_history_attach (NavigationHistory *history,
+                           guint64            parent,
+                           NavigationPath    *path,
+                           gint               line_number)
+{
+  guint64 id;
+  id = add_node (history, parent, path, line_number);
+  return &history->nodes[NODE_SLOT (history, id)];
+}
+
+void
+navigation_history_set_active_child (NavigationHistory *history,
+                                     guint64            id)
+{
+  guint64 parent;
+
+  parent = navigation_history_get_parent (history, id);
+  if (parent != NAVIGATION_HISTORY_NONE)
+    LINK (history, parent)->active_child = id;
+}
+
+/*
+ * Replaces the trail with the one starting at root and following the active
+ * children down, and moves to its end.
+ */
+void
+navigation_history_set_trail (NavigationHistory *history,
+                              guint64            root)
+{
+  history->head = 0;
+  history->length = 0;
+  history->position = 0;
+
+  if (!contains (history, root))
+    return;
+
+  extend_trail (history, root);
+  history->position = history->length - 1;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_HISTORY_H__
+#define __NAVIGATION_HISTORY_H__
+
+#include <glib.h>
+#include "navigation-node.h"
+
+G_BEGIN_DECLS
+
+/*
+ * A capacity bounded tree of navigation entries, kept like an undo tree. The
+ * nodes live by value in a slab in creation order, linked to each other by
+ * id, and pushing onto a full history evicts the oldest node.
+ *
+ * Jumping somewhere new after walking back starts a new branch under the
+ * current node rather than dropping the forward entries. The trail is the
+ * path from a root down through the active child of each node, and it is
+ * what walking back and forward moves along. Index based accessors address
+ * the trail, ids address any node in the tree.
+ */
+typedef struct _NavigationHistory NavigationHistory;
+
+#define NAVIGATION_HISTORY_NONE G_MAXUINT64
+
+NavigationHistory*  navigation_history_new                (guint              capacity);
+void                navigation_history_free               (NavigationHistory *history);
+
+guint               navigation_history_get_capacity       (NavigationHistory *history);
+void                navigation_history_set_capacity       (NavigationHistory *history,
+                                                           guint              capacity);
+guint               navigation_history_get_length         (NavigationHistory *history);
+guint64             navigation_history_get_offset         (NavigationHistory *history);
+gint                navigation_history_get_position       (NavigationHistory *history);
+void                navigation_history_set_position       (NavigationHistory *history,
+                                                           gint               position);
+
+NavigationNode*     navigation_history_get                (NavigationHistory *history,
+                                                           guint              index);
+NavigationNode*     navigation_history_get_current        (NavigationHistory *history);
+guint64             navigation_history_get_id             (NavigationHistory *history,
+                                                           guint              index);
+guint               navigation_history_get_branch_count   (NavigationHistory *history,
+                                                           guint              index);
+
+guint64             navigation_history_get_first_id       (NavigationHistory *history);
+guint64             navigation_history_get_next_id        (NavigationHistory *history);
+NavigationNode*     navigation_history_lookup             (NavigationHistory *history,
+                                                           guint64            id);
+guint64             navigation_history_get_parent         (NavigationHistory *history,
+                                                           guint64            id);
+guint64             navigation_history_get_active_child   (NavigationHistory *history,
+                                                           guint64            id);
+guint64             navigation_history_get_first_child    (NavigationHistory *history,
+                                                           guint64            id);
+
+NavigationNode*     navigation_history_push               (NavigationHistory *history,
+                                                           NavigationPath    *path,
+                                                           gint               line_number);
+gboolean            navigation_history_switch_branch      (NavigationHistory *history,
+                                                           gint               direction);
+void                navigation_history_clear              (NavigationHistory *history);
+
+NavigationNode*     navigation_history_attach             (NavigationHistory *history,
+                                                           guint64            parent,
+                                                           NavigationPath    *path,
+                                                           gint               line_number);
+void                navigation_history_set_active_child   (NavigationHistory *history,
+                                                           guint64            id);
+void                navigation_history_set_trail          (NavigationHistory *history,
+                                                           guint64            root);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_HISTORY_H__ */
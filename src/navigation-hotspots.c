@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <math.h>
+#include "navigation-hotspots.h"
+
+#define BUCKET_LINES 20
+#define HALF_LIFE (3 * G_TIME_SPAN_DAY)
+
+struct _NavigationHotspot
+{
+  NavigationPath *path;
+  gint            bucket;
+  gint            line_number;
+  guint           visit_count;
+  gint64          last_visit;
+  gdouble         score;
+  GSequenceIter  *rank;
+};
+
+struct _NavigationHotspots
+{
+  GHashTable *index;
+  GSequence  *ranking;
+  guint       max_size;
+  guint       stamp;
+};
+
+static guint
+hotspot_hash (gconstpointer key)
+{
+  const NavigationHotspot *hotspot = key;
+  return g_direct_hash (hotspot->path) ^ (hotspot->bucket * 2654435761u);
+}
+
+static gboolean
+hotspot_equal (gconstpointer a,
+               gconstpointer b)
+{
+  const NavigationHotspot *hotspot_a = a;
+  const NavigationHotspot *hotspot_b = b;
+  return hotspot_a->path == hotspot_b->path && hotspot_a->bucket == hotspot_b->bucket;
+}
+
+static void
+hotspot_free (NavigationHotspot *hotspot)
+{
+  navigation_path_unref (hotspot->path);
+  g_slice_free (NavigationHotspot, hotspot);
+}
+
+/*
+ * Hottest first, and the most recent first between equals.
+ */
+static gint
+compare_rank (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+  const NavigationHotspot *hotspot_a = a;
+  const NavigationHotspot *hotspot_b = b;
+
+  if (hotspot_a->score != hotspot_b->score)
+    return hotspot_a->score > hotspot_b->score ? -1 : 1;
+  if (hotspot_a->last_visit != hotspot_b->last_visit)
+    return hotspot_a->last_visit > hotspot_b->last_visit ? -1 : 1;
+  return 0;
+}
+
+NavigationHotspots*
+navigation_hotspots_new (guint max_size)
+{
+  NavigationHotspots *hotspots;
+
+  g_return_val_if_fail (max_size > 0, NULL);
+
+  hotspots = g_new0 (NavigationHotspots, 1);
+  hotspots->index = g_hash_table_new_full (hotspot_hash, hotspot_equal, 
+                                           (GDestroyNotify) hotspot_free, NULL);
+  hotspots->ranking = g_sequence_new (NULL);
+  hotspots->max_size = max_size;
+
+  return hotspots;
+}
+
+void
+navigation_hotspots_free (NavigationHotspots *hotspots)
+{
+  g_sequence_free (hotspots->ranking);
+  g_hash_table_destroy (hotspots->index);
+  g_free (hotspots);
+}
+
+/*
+ * The score is the log of the sum of 2^(t / HALF_LIFE) over all visits. Every
+ * score decays at the same rate, so the ranking never has to be revisited as
+ * time passes, and keeping it as a log means it never overflows.
+ */
+static gdouble
+add_visit (gdouble score,
+           gint64  timestamp)
+{
+  gdouble visit;
+  
+  visit = ((gdouble) timestamp / HALF_LIFE) * G_LN2;
+
+  if (score == -HUGE_VAL)
+    return visit;
+  if (score > visit)
+    return score + log1p (exp (visit - score));
+  return visit + log1p (exp (score - visit));
+}
+
+static void
+evict_coldest (NavigationHotspots *hotspots)
+{
+  GSequenceIter *coldest;
+
+  coldest = g_sequence_iter_prev (g_sequence_get_end_iter (hotspots->ranking));
+  g_hash_table_remove (hotspots->index, g_sequence_get (coldest));
+  g_sequence_remove (coldest);
+}
+
+void
+navigation_hotspots_visit (NavigationHotspots *hotspots,
+                           NavigationPath     *path,
+                           gint                line_number,
+                           gint64              timestamp)
+{
+  NavigationHotspot key;
+  NavigationHotspot *hotspot;
+
+  key.path = path;
+  key.bucket = line_number / BUCKET_LINES;
+
+  hotspot = g_hash_table_lookup (hotspots->index, &key);
+
+  if (hotspot == NULL)
+    {
+      if (g_hash_table_size (hotspots->index) >= hotspots->max_size)
+        evict_coldest (hotspots);
+
+      hotspot = g_slice_new (NavigationHotspot);
+      hotspot->path = navigation_path_ref (path);
+      hotspot->bucket = key.bucket;
+      hotspot->visit_count = 0;
+      hotspot->last_visit = G_MININT64;
+      hotspot->score = -HUGE_VAL;
+      hotspot->rank = NULL;
+      g_hash_table_add (hotspots->index, hotspot);
+    }
+  
+  hotspot->visit_count++;
+  hotspot->score = add_visit (hotspot->score, timestamp);
+  
+  /* visits may be replayed out of order, the line shown is the newest one */
+  if (timestamp >= hotspot->last_visit)
+    {
+      hotspot->line_number = line_number;
+      hotspot->last_visit = timestamp;
+    }
+  
+  /* a repeat visit moves the hotspot without reallocating its place */
+  if (hotspot->rank == NULL)
+    hotspot->rank = g_sequence_insert_sorted (hotspots->ranking, hotspot, compare_rank, NULL);
+  else
+    g_sequence_sort_changed (hotspot->rank, compare_rank, NULL);
+  hotspots->stamp++;
+}
+
+void
+navigation_hotspots_remove (NavigationHotspots *hotspots,
+                            NavigationPath     *path,
+                            gint                line_number)
+{
+  NavigationHotspot key;
+  NavigationHotspot *hotspot;
+
+  key.path = path;
+  key.bucket = line_number / BUCKET_LINES;
+
+  hotspot = g_hash_table_lookup (hotspots->index, &key);
+  if (hotspot == NULL)
+    return;
+
+  g_sequence_remove (hotspot->rank);
+  g_hash_table_remove (hotspots->index, hotspot);
+  hotspots->stamp++;
+}
+
+void
+navigation_hotspots_clear (NavigationHotspots *hotspots)
+{
+  g_sequence_remove_range (g_sequence_get_begin_iter (hotspots->ranking), 
+                           g_sequence_get_end_iter (hotspots->ranking));
+  g_hash_table_remove_all (hotspots->index);
+  hotspots->stamp++;
+}
+
+guint
+navigation_hotspots_get_size (NavigationHotspots *hotspots)
+{
+  return g_hash_table_size (hotspots->index);
+}
+
+/*
+ * Changes whenever the ranking might have, so a view can tell whether it is
+ * worth asking for the top hotspots again.
+ */
+guint
+navigation_hotspots_get_stamp (NavigationHotspots *hotspots)
+{
+  return hotspots->stamp;
+}
+
+/*
+ * Fills top with up to count of the hottest hotspots, hottest first, and
+ * returns how many it filled. The hotspots are owned by the index and only
+ * stay valid until it next changes.
+ */
+guint
+navigation_hotspots_get_top (NavigationHotspots *hotspots,
+                             NavigationHotspot **top,
+                             guint               count)
+{
+  GSequenceIter *iter;
+  guint filled = 0;
+
+  for (iter = g_sequence_get_begin_iter (hotspots->ranking); 
+       filled < count && !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    top[filled++] = g_sequence_get (iter);
+
+  return filled;
+}
+
+NavigationPath*
+navigation_hotspot_get_path (NavigationHotspot *hotspot)
+{
+  return hotspot->path;
+}
+
+gint
+navigation_hotspot_get_line_number (NavigationHotspot *hotspot)
+{
+  return hotspot->line_number;
+}
+
+guint
+navigation_hotspot_get_visit_count (NavigationHotspot *hotspot)
+{
+  return hotspot->visit_count;
+}
+
+gint64
+navigation_hotspot_get_last_visit (NavigationHotspot *hotspot)
+{
+  return hotspot->last_visit;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_HOTSPOTS_H__
+#define __NAVIGATION_HOTSPOTS_H__
+
+#include <glib.h>
+#include "navigation-path.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Every visited location, keyed by file and a bucket of nearby lines, ranked
+ * by frecency: each visit counts for one, halving in weight every half life.
+ * The index holds at most max_size hotspots and forgets the coldest first.
+ */
+typedef struct _NavigationHotspots NavigationHotspots;
+typedef struct _NavigationHotspot NavigationHotspot;
+
+NavigationHotspots*  navigation_hotspots_new              (guint               max_size);
+void                 navigation_hotspots_free             (NavigationHotspots *hotspots);
+
+void                 navigation_hotspots_visit            (NavigationHotspots *hotspots,
+                                                           NavigationPath     *path,
+                                                           gint                line_number,
+                                                           gint64              timestamp);
+void                 navigation_hotspots_remove           (NavigationHotspots *hotspots,
+                                                           NavigationPath     *path,
+                                                           gint                line_number);
+void                 navigation_hotspots_clear            (NavigationHotspots *hotspots);
+
+guint                navigation_hotspots_get_size         (NavigationHotspots *hotspots);
+guint                navigation_hotspots_get_stamp        (NavigationHotspots *hotspots);
+guint                navigation_hotspots_get_top          (NavigationHotspots *hotspots,
+                                                           NavigationHotspot **top,
+                                                           guint               count);
+
+NavigationPath*      navigation_hotspot_get_path          (NavigationHotspot  *hotspot);
+gint                 navigation_hotspot_get_line_number   (NavigationHotspot  *hotspot);
+guint                navigation_hotspot_get_visit_count   (NavigationHotspot  *hotspot);
+gint64               navigation_hotspot_get_last_visit    (NavigationHotspot  *hotspot);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_HOTSPOTS_H__ */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#include "navigation-ingest.h"
+
+/*
+ * The queue is a stack that producers push onto with compare and exchange.
+ * The main loop takes the whole stack in one exchange and reverses it, and
+ * since nothing ever pops a single event there is no ABA to worry about.
+ * Only the push that finds the stack empty adds an idle, so a burst of
+ * events costs one wakeup and one batch.
+ */
+
+typedef struct _Event Event;
+
+struct _Event
+{
+  Event *next;
+  gchar *from_file_path;
+  gint   from_line_number;
+  gchar *to_file_path;
+  gint   to_line_number;
+};
+
+struct _NavigationIngest
+{
+  volatile gint         ref_count;
+  gpointer              head;
+  NavigationIngestFunc  func;
+  gpointer              user_data;
+};
+
+static void
+event_free (Event *event)
+{
+  g_free (event->from_file_path);
+  g_free (event->to_file_path);
+  g_slice_free (Event, event);
+}
+
+static Event*
+take_events (NavigationIngest *ingest)
+{
+  Event *head;
+  Event *events = NULL;
+
+  do
+    head = g_atomic_pointer_get (&ingest->head);
+  while (!g_atomic_pointer_compare_and_exchange (&ingest->head, head, NULL));
+
+  /* newest first on the stack, so turn it around */
+  while (head != NULL)
+    {
+      Event *next = head->next;
+      head->next = events;
+      events = head;
+      head = next;
+    }
+
+  return events;
+}
+
+static NavigationIngest*
+ingest_ref (NavigationIngest *ingest)
+{
+  g_atomic_int_inc (&ingest->ref_count);
+  return ingest;
+}
+
+static void
+ingest_unref (NavigationIngest *ingest)
+{
+  Event *events;
+
+  if (!g_atomic_int_dec_and_test (&ingest->ref_count))
+    return;
+
+  events = take_events (ingest);
+  while (events != NULL)
+    {
+      Event *next = events->next;
+      event_free (events);
+      events = next;
+    }
+
+  g_slice_free (NavigationIngest, ingest);
+}
+
+NavigationIngest*
+navigation_ingest_new (NavigationIngestFunc func,
+                       gpointer             user_data)
+{
+  NavigationIngest *ingest;
+
+  ingest = g_slice_new0 (NavigationIngest);
+  ingest->ref_count = 1;
+  ingest->func = func;
+  ingest->user_data = user_data;
+
+  return ingest;
+}
+
+/*
+ * Called on the main thread once no more pushes can come. An idle that is
+ * still pending keeps the queue alive and drops what it finds.
+ */
+void
+navigation_ingest_free (NavigationIngest *ingest)
+{
+  ingest->func = NULL;
+  ingest->user_data = NULL;
+  ingest_unref (ingest);
+}
+
+static gboolean
+drain (NavigationIngest *ingest)
+{
+  Event *events;
+
+  events = take_events (ingest);
+
+  while (events != NULL)
+    {
+      Event *next = events->next;
+
+      if (ingest->func != NULL)
+        ingest->func (ingest->user_data, 
+                      events->from_file_path, events->from_line_number, 
+                      events->to_file_path, events->to_line_number);
+
+      event_free (events);
+      events = next;
+    }
+
+  return FALSE;
+}
+
+void
+navigation_ingest_push (NavigationIngest *ingest,
+                        const gchar      *from_file_path,
+                        gint              from_line_number,
+                        const gchar      *to_file_path,
+                        gint              to_line_number)
+{
+  Event *event;
+  Event *head;
+
+  event = g_slice_new (Event);
+  event->from_file_path = g_strdup (from_file_path);
+  event->from_line_number = from_line_number;
+  event->to_file_path = g_strdup (to_file_path);
+  event->to_line_number = to_line_number;
+
+  do
+    {
+      head = g_atomic_pointer_get (&ingest->head);
+      event->next = head;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (&ingest->head, head, event));
+
+  if (head == NULL)
+    g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, (GSourceFunc) drain, 
+                     ingest_ref (ingest), (GDestroyNotify) ingest_unref);
+}
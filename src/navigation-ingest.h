@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#ifndef __NAVIGATION_INGEST_H__
+#define __NAVIGATION_INGEST_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Jumps reported from other threads. Pushing is lock free and may happen on
+ * any thread; the events are handed to the callback on the main loop, all
+ * that have piled up since the last time in one go and in push order.
+ */
+typedef struct _NavigationIngest NavigationIngest;
+
+typedef void (*NavigationIngestFunc) (gpointer     user_data,
+                                      gchar       *from_file_path,
+                                      gint         from_line_number,
+                                      gchar       *to_file_path,
+                                      gint         to_line_number);
+
+NavigationIngest*  navigation_ingest_new   (NavigationIngestFunc  func,
+                                            gpointer              user_data);
+void               navigation_ingest_free  (NavigationIngest     *ingest);
+
+void               navigation_ingest_push  (NavigationIngest     *ingest,
+                                            const gchar          *from_file_path,
+                                            gint                  from_line_number,
+                                            const gchar          *to_file_path,
+                                            gint                  to_line_number);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_INGEST_H__ */
@@ -0,0 +1,940 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include "navigation-journal.h"
+
+/*
+ * An append-only binary log of history changes that is replayed on startup.
+ *
+ * The file starts with the magic "NAVJ" and a version byte, followed by
+ * records made of a tag byte and unsigned LEB128 varints:
+ *
+ *   'P' id length bytes           interns a file path under id
+ *   'N' id line-delta time-delta  pushes a node, the deltas are zigzag
+ *                                 encoded against the previous node
+ *   'S' position                  moves the position
+ *   'B' direction                 switches to a sibling branch
+ *   'F' back fingerprint          sets the line fingerprint of the node
+ *                                 created back nodes before the last one
+ *   'O'                           marks the node created just before as
+ *                                 where a jump started from
+ *
+ * Records are buffered in memory and appended to the file from a worker
+ * thread. Once the log has grown well past the live history the engine
+ * asks for it to be rewritten as a snapshot of the current tree, which
+ * uses three more records. Nodes are numbered in the order the file
+ * creates them:
+ *
+ *   'A' id line-delta time-delta parent
+ *                                 adds a node under node parent - 1, or as
+ *                                 a root when parent is 0
+ *   'V' node                      makes node the active child of its parent
+ *   'R' node                      makes the trail start at node
+ */
+
+static void navigation_journal_class_init  (NavigationJournalClass *klass);
+static void navigation_journal_init        (NavigationJournal      *journal);
+static void navigation_journal_finalize    (NavigationJournal      *journal);
+
+static void schedule_flush                 (NavigationJournal      *journal);
+
+#define NAVIGATION_JOURNAL_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_JOURNAL_TYPE, NavigationJournalPrivate))
+
+#define MAGIC "NAVJ"
+#define MAGIC_LENGTH 4
+#define VERSION 1
+#define FLUSH_INTERVAL 2
+
+enum
+{
+  RECORD_PATH = 'P',
+  RECORD_NODE = 'N',
+  RECORD_POSITION = 'S',
+  RECORD_BRANCH = 'B',
+  RECORD_ATTACH = 'A',
+  RECORD_ACTIVE = 'V',
+  RECORD_TRAIL = 'R',
+  RECORD_FINGERPRINT = 'F',
+  RECORD_ORIGIN = 'O'
+};
+
+typedef struct _NavigationJournalPrivate NavigationJournalPrivate;
+
+struct _NavigationJournalPrivate
+{
+  gchar      *file_path;
+  GHashTable *ids;
+  guint       next_id;
+  gint        last_line;
+  gint64      last_timestamp;
+  guint       record_count;
+  guint       flush_id;
+  gboolean    writing;
+  gboolean    closed;
+  GMutex      lock;
+  GMutex      write_lock;
+  GByteArray *pending;
+  gboolean    replace;
+};
+
+typedef struct
+{
+  guint8 type;
+  guint  value;
+  guint  parent;    /* how far back, for a fingerprint */
+  gint   line;
+  gint64 timestamp;
+} Record;
+
+typedef struct
+{
+  GPtrArray *paths;
+  GArray    *records;
+  gint       last_line;
+  gint64     last_timestamp;
+  gboolean   damaged;
+  gboolean   unreadable;
+} LoadResult;
+
+G_DEFINE_TYPE (NavigationJournal, navigation_journal, G_TYPE_OBJECT)
+
+static void
+navigation_journal_class_init (NavigationJournalClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) navigation_journal_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationJournalPrivate));
+}
+
+static void
+navigation_journal_init (NavigationJournal *journal)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  priv->file_path = NULL;
+  priv->ids = g_hash_table_new_full (g_direct_hash, g_direct_equal, 
+                                     (GDestroyNotify) navigation_path_unref, NULL);
+  priv->next_id = 0;
+  priv->last_line = 0;
+  priv->last_timestamp = 0;
+  priv->record_count = 0;
+  priv->flush_id = 0;
+  priv->writing = FALSE;
+  priv->closed = FALSE;
+  g_mutex_init (&priv->lock);
+  g_mutex_init (&priv->write_lock);
+  priv->pending = g_byte_array_new ();
+  priv->replace = FALSE;
+}
+
+static void
+navigation_journal_finalize (NavigationJournal *journal)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->flush_id != 0)
+    g_source_remove (priv->flush_id);
+
+  g_free (priv->file_path);
+  g_hash_table_destroy (priv->ids);
+  g_byte_array_unref (priv->pending);
+  g_mutex_clear (&priv->lock);
+  g_mutex_clear (&priv->write_lock);
+
+  G_OBJECT_CLASS (navigation_journal_parent_class)->finalize (G_OBJECT (journal));
+}
+
+NavigationJournal*
+navigation_journal_new (const gchar *file_path)
+{
+  NavigationJournalPrivate *priv;
+  NavigationJournal *journal;
+
+  journal = NAVIGATION_JOURNAL (g_object_new (navigation_journal_get_type (), NULL));
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  priv->file_path = g_strdup (file_path);
+
+  return journal;
+}
+
+static void
+write_varint (GByteArray *bytes,
+              guint64     value)
+{
+  guint8 buffer[10];
+  guint length = 0;
+
+  do
+    {
+      buffer[length] = value & 0x7f;
+      value >>= 7;
+      if (value != 0)
+        buffer[length] |= 0x80;
+      length++;
+    }
+  while (value != 0);
+
+  g_byte_array_append (bytes, buffer, length);
+}
+
+static gboolean
+read_varint (const guint8 **data,
+             const guint8  *end,
+             guint64       *value)
+{
+  guint64 result = 0;
+  guint shift = 0;
+
+  while (*data < end && shift < 64)
+    {
+      guint8 byte = *(*data)++;
+      result |= (guint64) (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        {
+          *value = result;
+          return TRUE;
+        }
+      shift += 7;
+    }
+
+  return FALSE;
+}
+
+static guint64
+zigzag_encode (gint64 value)
+{
+  return ((guint64) value << 1) ^ (guint64) (value >> 63);
+}
+
+static gint64
+zigzag_decode (guint64 value)
+{
+  return (gint64) (value >> 1) ^ -(gint64) (value & 1);
+}
+
+static void
+write_tag (GByteArray *bytes,
+           guint8      tag)
+{
+  g_byte_array_append (bytes, &tag, 1);
+}
+
+static void
+encode_node (NavigationJournal *journal,
+             GByteArray        *bytes,
+             guint8             tag,
+             NavigationNode    *node)
+{
+  NavigationJournalPrivate *priv;
+  NavigationPath *path;
+  gpointer value;
+  gint line_number;
+  guint id;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  path = navigation_node_get_path (node);
+  value = g_hash_table_lookup (priv->ids, path);
+
+  if (value != NULL)
+    {
+      id = GPOINTER_TO_UINT (value) - 1;
+    }
+  else
+    {
+      const gchar *file_path;
+      gsize length;
+
+      id = priv->next_id++;
+      g_hash_table_insert (priv->ids, navigation_path_ref (path), GUINT_TO_POINTER (id + 1));
+
+      file_path = navigation_path_get_file_path (path);
+      length = strlen (file_path);
+
+      write_tag (bytes, RECORD_PATH);
+      write_varint (bytes, id);
+      write_varint (bytes, length);
+      g_byte_array_append (bytes, (const guint8 *) file_path, length);
+      priv->record_count++;
+    }
+
+  line_number = navigation_node_get_line_number (node);
+
+  write_tag (bytes, tag);
+  write_varint (bytes, id);
+  write_varint (bytes, zigzag_encode ((gint64) line_number - priv->last_line));
+  write_varint (bytes, zigzag_encode (navigation_node_get_timestamp (node) - priv->last_timestamp));
+  priv->last_line = line_number;
+  priv->last_timestamp = navigation_node_get_timestamp (node);
+  priv->record_count++;
+}
+
+/* follows the node's own record, as the snapshot adds the parent to that */
+static void
+encode_fingerprint (NavigationJournal *journal,
+                    GByteArray        *bytes,
+                    guint64            back,
+                    guint32            fingerprint)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  
+  if (fingerprint == 0)
+    return;
+  
+  write_tag (bytes, RECORD_FINGERPRINT);
+  write_varint (bytes, back);
+  write_varint (bytes, fingerprint);
+  priv->record_count++;
+}
+
+static void
+encode_origin (NavigationJournal *journal,
+               GByteArray        *bytes,
+               NavigationNode    *node)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  
+  if (!navigation_node_is_origin (node))
+    return;
+  
+  write_tag (bytes, RECORD_ORIGIN);
+  priv->record_count++;
+}
+
+static void
+encode_value (NavigationJournal *journal,
+              GByteArray        *bytes,
+              guint8             tag,
+              guint              value)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  write_tag (bytes, tag);
+  write_varint (bytes, value);
+  priv->record_count++;
+}
+
+void
+navigation_journal_push (NavigationJournal *journal,
+                         NavigationNode    *node)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  encode_node (journal, priv->pending, RECORD_NODE, node);
+  encode_fingerprint (journal, priv->pending, 0, navigation_node_get_fingerprint (node));
+  encode_origin (journal, priv->pending, node);
+  g_mutex_unlock (&priv->lock);
+
+  schedule_flush (journal);
+}
+
+/*
+ * Records a fingerprint that came in after node id of history was pushed.
+ * Every node the history makes goes through the journal, so how far back
+ * it is counts the same in both.
+ */
+void
+navigation_journal_set_fingerprint (NavigationJournal *journal,
+                                    NavigationHistory *history,
+                                    guint64            id,
+                                    guint32            fingerprint)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  encode_fingerprint (journal, priv->pending, 
+                      navigation_history_get_next_id (history) - 1 - id, fingerprint);
+  g_mutex_unlock (&priv->lock);
+
+  schedule_flush (journal);
+}
+
+void
+navigation_journal_switch_branch (NavigationJournal *journal,
+                                  gint               direction)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  write_tag (priv->pending, RECORD_BRANCH);
+  write_varint (priv->pending, zigzag_encode (direction));
+  priv->record_count++;
+  g_mutex_unlock (&priv->lock);
+
+  schedule_flush (journal);
+}
+
+void
+navigation_journal_set_position (NavigationJournal *journal,
+                                 gint               position)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed || position < 0)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  encode_value (journal, priv->pending, RECORD_POSITION, position);
+  g_mutex_unlock (&priv->lock);
+
+  schedule_flush (journal);
+}
+
+guint
+navigation_journal_get_record_count (NavigationJournal *journal)
+{
+  return NAVIGATION_JOURNAL_GET_PRIVATE (journal)->record_count;
+}
+
+/*
+ * Replaces whatever is waiting to be written with a snapshot of the tree,
+ * which the next flush writes over the old file.
+ */
+void
+navigation_journal_compact (NavigationJournal *journal,
+                            NavigationHistory *history)
+{
+  NavigationJournalPrivate *priv;
+  guint64 first_id;
+  guint64 next_id;
+  guint64 id;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed)
+    return;
+
+  g_hash_table_remove_all (priv->ids);
+  priv->next_id = 0;
+  priv->last_line = 0;
+  priv->last_timestamp = 0;
+  priv->record_count = 0;
+
+  g_mutex_lock (&priv->lock);
+
+  g_byte_array_set_size (priv->pending, 0);
+  priv->replace = TRUE;
+
+  g_byte_array_append (priv->pending, (const guint8 *) MAGIC, MAGIC_LENGTH);
+  write_tag (priv->pending, VERSION);
+
+  first_id = navigation_history_get_first_id (history);
+  next_id = navigation_history_get_next_id (history);
+
+  for (id = first_id; id < next_id; id++)
+    {
+      guint64 parent = navigation_history_get_parent (history, id);
+      NavigationNode *node = navigation_history_lookup (history, id);
+      encode_node (journal, priv->pending, RECORD_ATTACH, node);
+      write_varint (priv->pending, parent == NAVIGATION_HISTORY_NONE ? 0 : parent - first_id + 1);
+      encode_fingerprint (journal, priv->pending, 0, navigation_node_get_fingerprint (node));
+      encode_origin (journal, priv->pending, node);
+    }
+
+  /* a new child becomes the active one, so only older choices need saying */
+  for (id = first_id; id < next_id; id++)
+    {
+      guint64 active_child = navigation_history_get_active_child (history, id);
+      if (active_child != navigation_history_get_first_child (history, id))
+        encode_value (journal, priv->pending, RECORD_ACTIVE, active_child - first_id);
+    }
+
+  if (navigation_history_get_length (history) > 0)
+    {
+      encode_value (journal, priv->pending, RECORD_TRAIL, 
+                    navigation_history_get_id (history, 0) - first_id);
+      encode_value (journal, priv->pending, RECORD_POSITION, 
+                    navigation_history_get_position (history));
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  schedule_flush (journal);
+}
+
+static gboolean
+append_bytes (const gchar  *file_path,
+              GByteArray   *bytes,
+              GError      **error)
+{
+  GFileOutputStream *stream;
+  GFile *file;
+  gboolean result;
+
+  file = g_file_new_for_path (file_path);
+  stream = g_file_append_to (file, G_FILE_CREATE_NONE, NULL, error);
+  g_object_unref (file);
+
+  if (stream == NULL)
+    return FALSE;
+
+  result = g_output_stream_write_all (G_OUTPUT_STREAM (stream), bytes->data, bytes->len, 
+                                      NULL, NULL, error) &&
+           g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+
+  g_object_unref (stream);
+
+  return result;
+}
+
+/*
+ * Takes everything pending and writes it out. The write lock is taken before
+ * the pending bytes are stolen so that two writers can never reorder records
+ * in the file.
+ */
+static gboolean
+write_pending (NavigationJournal  *journal,
+               GError            **error)
+{
+  NavigationJournalPrivate *priv;
+  GByteArray *bytes;
+  gboolean replace;
+  gboolean result = TRUE;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  g_mutex_lock (&priv->write_lock);
+
+  g_mutex_lock (&priv->lock);
+  bytes = priv->pending;
+  replace = priv->replace;
+  priv->pending = g_byte_array_new ();
+  priv->replace = FALSE;
+  g_mutex_unlock (&priv->lock);
+
+  if (bytes->len > 0)
+    {
+      if (replace)
+        result = g_file_set_contents (priv->file_path, (const gchar *) bytes->data, 
+                                      bytes->len, error);
+      else
+        result = append_bytes (priv->file_path, bytes, error);
+    }
+
+  g_mutex_unlock (&priv->write_lock);
+
+  g_byte_array_unref (bytes);
+
+  return result;
+}
+
+static void
+write_thread (GTask        *task,
+              gpointer      source_object,
+              gpointer      task_data,
+              GCancellable *cancellable)
+{
+  GError *error = NULL;
+
+  if (write_pending (NAVIGATION_JOURNAL (source_object), &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+write_done (GObject      *source_object,
+            GAsyncResult *result,
+            gpointer      user_data)
+{
+  NavigationJournalPrivate *priv;
+  GError *error = NULL;
+  gboolean more;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (source_object);
+  priv->writing = FALSE;
+
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    {
+      g_warning ("navigation: unable to write %s: %s", priv->file_path, error->message);
+      g_error_free (error);
+    }
+
+  g_mutex_lock (&priv->lock);
+  more = priv->pending->len > 0;
+  g_mutex_unlock (&priv->lock);
+
+  if (more)
+    schedule_flush (NAVIGATION_JOURNAL (source_object));
+}
+
+static gboolean
+flush_timeout (NavigationJournal *journal)
+{
+  NavigationJournalPrivate *priv;
+  GTask *task;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+  priv->flush_id = 0;
+  priv->writing = TRUE;
+
+  task = g_task_new (journal, NULL, write_done, NULL);
+  g_task_run_in_thread (task, write_thread);
+  g_object_unref (task);
+
+  return FALSE;
+}
+
+static void
+schedule_flush (NavigationJournal *journal)
+{
+  NavigationJournalPrivate *priv;
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed || priv->writing || priv->flush_id != 0)
+    return;
+
+  priv->flush_id = g_timeout_add_seconds (FLUSH_INTERVAL, (GSourceFunc) flush_timeout, journal);
+}
+
+/*
+ * Writes out whatever is still pending, after any write already running in
+ * the background, and stops accepting records.
+ */
+void
+navigation_journal_close (NavigationJournal *journal)
+{
+  NavigationJournalPrivate *priv;
+  GError *error = NULL;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  if (priv->closed)
+    return;
+
+  priv->closed = TRUE;
+
+  if (priv->flush_id != 0)
+    {
+      g_source_remove (priv->flush_id);
+      priv->flush_id = 0;
+    }
+
+  if (!write_pending (journal, &error))
+    {
+      g_warning ("navigation: unable to write %s: %s", priv->file_path, error->message);
+      g_error_free (error);
+    }
+}
+
+static void
+load_result_free (LoadResult *load)
+{
+  g_ptr_array_free (load->paths, TRUE);
+  g_array_free (load->records, TRUE);
+  g_slice_free (LoadResult, load);
+}
+
+/*
+ * Decodes as many records as are intact. A torn or corrupt tail, say from a
+ * crash in the middle of an append, marks the result as damaged rather than
+ * failing the whole load.
+ */
+static LoadResult*
+parse (const guint8 *data,
+       gsize         length)
+{
+  LoadResult *load;
+  const guint8 *end;
+  gint line = 0;
+  gint64 timestamp = 0;
+
+  load = g_slice_new0 (LoadResult);
+  load->paths = g_ptr_array_new_with_free_func (g_free);
+  load->records = g_array_new (FALSE, FALSE, sizeof (Record));
+
+  if (data == NULL || length < MAGIC_LENGTH + 1 || 
+      memcmp (data, MAGIC, MAGIC_LENGTH) != 0 || data[MAGIC_LENGTH] != VERSION)
+    {
+      load->damaged = TRUE;
+      load->unreadable = length > 0;
+      return load;
+    }
+
+  end = data + length;
+  data += MAGIC_LENGTH + 1;
+
+  while (data < end)
+    {
+      Record record = { 0 };
+      guint64 id;
+      guint64 value;
+      guint64 delta;
+
+      record.type = *data++;
+
+      switch (record.type)
+        {
+        case RECORD_PATH:
+          if (!read_varint (&data, end, &id) || id > load->paths->len ||
+              !read_varint (&data, end, &value) || value > (guint64) (end - data))
+            goto damaged;
+          if (id == load->paths->len)
+            g_ptr_array_add (load->paths, NULL);
+          g_free (g_ptr_array_index (load->paths, id));
+          g_ptr_array_index (load->paths, id) = g_strndup ((const gchar *) data, value);
+          data += value;
+          record.value = id;
+          break;
+        case RECORD_NODE:
+        case RECORD_ATTACH:
+          if (!read_varint (&data, end, &id) || id >= load->paths->len ||
+              !read_varint (&data, end, &delta))
+            goto damaged;
+          line += (gint) zigzag_decode (delta);
+          if (!read_varint (&data, end, &delta))
+            goto damaged;
+          timestamp += zigzag_decode (delta);
+          if (record.type == RECORD_ATTACH && 
+              (!read_varint (&data, end, &value) || value > G_MAXINT))
+            goto damaged;
+          record.value = id;
+          record.parent = record.type == RECORD_ATTACH ? value : 0;
+          record.line = line;
+          record.timestamp = timestamp;
+          break;
+        case RECORD_ORIGIN:
+          break;
+        case RECORD_POSITION:
+        case RECORD_BRANCH:
+        case RECORD_ACTIVE:
+        case RECORD_TRAIL:
+          if (!read_varint (&data, end, &value) || value > G_MAXINT)
+            goto damaged;
+          record.value = value;
+          break;
+        case RECORD_FINGERPRINT:
+          if (!read_varint (&data, end, &id) || id > G_MAXINT ||
+              !read_varint (&data, end, &value) || value > G_MAXUINT32)
+            goto damaged;
+          record.parent = id;
+          record.value = value;
+          break;
+        default:
+          goto damaged;
+        }
+
+      g_array_append_val (load->records, record);
+      load->last_line = line;
+      load->last_timestamp = timestamp;
+    }
+
+  return load;
+
+damaged:
+  load->damaged = TRUE;
+  return load;
+}
+
+static void
+load_thread (GTask        *task,
+             gpointer      source_object,
+             gpointer      task_data,
+             GCancellable *cancellable)
+{
+  NavigationJournalPrivate *priv;
+  GMappedFile *mapped_file;
+  LoadResult *load;
+  GError *error = NULL;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (source_object);
+
+  mapped_file = g_mapped_file_new (priv->file_path, FALSE, &error);
+  if (mapped_file == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  load = parse ((const guint8 *) g_mapped_file_get_contents (mapped_file), 
+                g_mapped_file_get_length (mapped_file));
+
+  g_mapped_file_unref (mapped_file);
+
+  g_task_return_pointer (task, load, (GDestroyNotify) load_result_free);
+}
+
+/*
+ * Maps and decodes the journal on a worker thread. The records are replayed
+ * into the history back on the main thread by navigation_journal_load_finish.
+ */
+void
+navigation_journal_load_async (NavigationJournal   *journal,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  GTask *task;
+  task = g_task_new (journal, cancellable, callback, user_data);
+  g_task_run_in_thread (task, load_thread);
+  g_object_unref (task);
+}
+
+static void
+replay (NavigationJournal  *journal,
+        LoadResult         *load,
+        NavigationHistory  *history,
+        NavigationPathPool *pool)
+{
+  NavigationJournalPrivate *priv;
+  NavigationPath **paths;
+  NavigationNode *node;
+  GArray *nodes;
+  Record *record;
+  guint64 parent;
+  guint64 id;
+  guint i;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  paths = g_new0 (NavigationPath*, load->paths->len);
+  nodes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  for (i = 0; i < load->records->len; i++)
+    {
+      record = &g_array_index (load->records, Record, i);
+
+      switch (record->type)
+        {
+        case RECORD_PATH:
+          if (paths[record->value] != NULL)
+            navigation_path_unref (paths[record->value]);
+          paths[record->value] = navigation_path_pool_intern (pool, 
+                                                              g_ptr_array_index (load->paths, record->value));
+          if (!g_hash_table_contains (priv->ids, paths[record->value]))
+            g_hash_table_insert (priv->ids, navigation_path_ref (paths[record->value]), 
+                                 GUINT_TO_POINTER (record->value + 1));
+          priv->next_id = MAX (priv->next_id, record->value + 1);
+          break;
+        case RECORD_NODE:
+          node = navigation_history_push (history, paths[record->value], record->line);
+          navigation_node_set_timestamp (node, record->timestamp);
+          id = navigation_history_get_next_id (history) - 1;
+          g_array_append_val (nodes, id);
+          break;
+        case RECORD_ATTACH:
+          parent = NAVIGATION_HISTORY_NONE;
+          if (record->parent > 0 && record->parent <= nodes->len)
+            parent = g_array_index (nodes, guint64, record->parent - 1);
+          node = navigation_history_attach (history, parent, paths[record->value], record->line);
+          navigation_node_set_timestamp (node, record->timestamp);
+          id = navigation_history_get_next_id (history) - 1;
+          g_array_append_val (nodes, id);
+          break;
+        case RECORD_ACTIVE:
+          if (record->value < nodes->len)
+            navigation_history_set_active_child (history, g_array_index (nodes, guint64, record->value));
+          break;
+        case RECORD_TRAIL:
+          if (record->value < nodes->len)
+            navigation_history_set_trail (history, g_array_index (nodes, guint64, record->value));
+          break;
+        case RECORD_POSITION:
+          if (record->value < navigation_history_get_length (history))
+            navigation_history_set_position (history, record->value);
+          break;
+        case RECORD_BRANCH:
+          navigation_history_switch_branch (history, (gint) zigzag_decode (record->value));
+          break;
+        case RECORD_FINGERPRINT:
+          node = NULL;
+          if (record->parent < nodes->len)
+            node = navigation_history_lookup (history, g_array_index (nodes, guint64, nodes->len - 1 - record->parent));
+          if (node != NULL)
+            navigation_node_set_fingerprint (node, record->value);
+          break;
+        case RECORD_ORIGIN:
+          node = NULL;
+          if (nodes->len > 0)
+            node = navigation_history_lookup (history, g_array_index (nodes, guint64, nodes->len - 1));
+          if (node != NULL)
+            navigation_node_set_origin (node, TRUE);
+          break;
+        }
+    }
+
+  g_array_free (nodes, TRUE);
+
+  for (i = 0; i < load->paths->len; i++)
+    if (paths[i] != NULL)
+      navigation_path_unref (paths[i]);
+
+  g_free (paths);
+
+  priv->last_line = load->last_line;
+  priv->last_timestamp = load->last_timestamp;
+  priv->record_count = load->records->len;
+}
+
+/*
+ * Replays the loaded journal into an empty history. When there was no
+ * journal, or its tail was damaged, a fresh snapshot is written in its place.
+ */
+gboolean
+navigation_journal_load_finish (NavigationJournal   *journal,
+                                GAsyncResult        *result,
+                                NavigationHistory   *history,
+                                NavigationPathPool  *pool,
+                                GError             **error)
+{
+  NavigationJournalPrivate *priv;
+  LoadResult *load;
+
+  priv = NAVIGATION_JOURNAL_GET_PRIVATE (journal);
+
+  load = g_task_propagate_pointer (G_TASK (result), error);
+
+  if (load == NULL)
+    {
+      navigation_journal_compact (journal, history);
+      return FALSE;
+    }
+
+  /* the compaction below writes over it */
+  if (load->unreadable)
+    g_warning ("navigation: %s is not a journal this version can read, its history is discarded", 
+               priv->file_path);
+
+  replay (journal, load, history, pool);
+
+  if (load->damaged)
+    navigation_journal_compact (journal, history);
+
+  load_result_free (load);
+
+  return TRUE;
+}
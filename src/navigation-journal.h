@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_JOURNAL_H__
+#define __NAVIGATION_JOURNAL_H__
+
+#include <gio/gio.h>
+#include "navigation-history.h"
+#include "navigation-path.h"
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_JOURNAL_TYPE            (navigation_journal_get_type ())
+#define NAVIGATION_JOURNAL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_JOURNAL_TYPE, NavigationJournal))
+#define NAVIGATION_JOURNAL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_JOURNAL_TYPE, NavigationJournalClass))
+#define IS_NAVIGATION_JOURNAL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_JOURNAL_TYPE))
+#define IS_NAVIGATION_JOURNAL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_JOURNAL_TYPE))
+
+typedef struct _NavigationJournal NavigationJournal;
+typedef struct _NavigationJournalClass NavigationJournalClass;
+
+struct _NavigationJournal
+{
+  GObject parent_instance;
+};
+
+struct _NavigationJournalClass
+{
+  GObjectClass parent_class;
+};
+
+GType navigation_journal_get_type (void) G_GNUC_CONST;
+
+NavigationJournal*  navigation_journal_new                (const gchar         *file_path);
+
+void                navigation_journal_load_async         (NavigationJournal   *journal,
+                                                           GCancellable        *cancellable,
+                                                           GAsyncReadyCallback  callback,
+                                                           gpointer             user_data);
+gboolean            navigation_journal_load_finish        (NavigationJournal   *journal,
+                                                           GAsyncResult        *result,
+                                                           NavigationHistory   *history,
+                                                           NavigationPathPool  *pool,
+                                                           GError             **error);
+
+void                navigation_journal_push               (NavigationJournal   *journal,
+                                                           NavigationNode      *node);
+void                navigation_journal_set_fingerprint    (NavigationJournal   *journal,
+                                                           NavigationHistory   *history,
+                                                           guint64              id,
+                                                           guint32              fingerprint);
+void                navigation_journal_switch_branch      (NavigationJournal   *journal,
+                                                           gint                 direction);
+void                navigation_journal_set_position       (NavigationJournal   *journal,
+                                                           gint                 position);
+
+guint               navigation_journal_get_record_count   (NavigationJournal   *journal);
+void                navigation_journal_compact            (NavigationJournal   *journal,
+                                                           NavigationHistory   *history);
+void                navigation_journal_close              (NavigationJournal   *journal);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_JOURNAL_H__ */
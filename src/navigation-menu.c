@@ -25,6 +25,8 @@ static void navigation_menu_finalize   (NavigationMenu      *menu);
 
 static void previous_action            (NavigationMenu      *menu);
 static void next_action                (NavigationMenu      *menu);
+static void previous_branch_action     (NavigationMenu      *menu);
+static void next_branch_action         (NavigationMenu      *menu);
 static void add_menu_items             (NavigationMenu      *menu,
                                         GtkWidget           *submenu,
                                         GtkAccelGroup       *accel_group);
@@ -33,6 +35,8 @@ enum
 {
   PREVIOUS,
   NEXT,
+  PREVIOUS_BRANCH,
+  NEXT_BRANCH,
   LAST_SIGNAL
 };
 
@@ -59,6 +63,22 @@ navigation_menu_class_init (NavigationMenuClass *klass)
                   NULL, NULL, 
                   g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
 
+  navigation_menu_signals[PREVIOUS_BRANCH] =
+    g_signal_new ("previous-branch", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationMenuClass, previous_branch),
+                  NULL, NULL, 
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+  navigation_menu_signals[NEXT_BRANCH] =
+    g_signal_new ("next-branch", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationMenuClass, next_branch),
+                  NULL, NULL, 
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
   G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) navigation_menu_finalize;
 }
 
@@ -97,6 +117,8 @@ add_menu_items (NavigationMenu *menu,
 {
   GtkWidget *previous_item;
   GtkWidget *next_item;
+  GtkWidget *previous_branch_item;
+  GtkWidget *next_branch_item;
 
   previous_item = codeslayer_menu_item_new_with_label (_("previous"));
   gtk_widget_add_accelerator (previous_item, "activate", accel_group, 
@@ -107,12 +129,28 @@ add_menu_items (NavigationMenu *menu,
   gtk_widget_add_accelerator (next_item, "activate", accel_group, 
                               GDK_KEY_Right, GDK_MOD1_MASK, GTK_ACCEL_VISIBLE);
   gtk_menu_shell_append (GTK_MENU_SHELL (submenu), next_item);
+
+  previous_branch_item = codeslayer_menu_item_new_with_label (_("previous branch"));
+  gtk_widget_add_accelerator (previous_branch_item, "activate", accel_group, 
+                              GDK_KEY_Up, GDK_MOD1_MASK, GTK_ACCEL_VISIBLE); 
+  gtk_menu_shell_append (GTK_MENU_SHELL (submenu), previous_branch_item);
+
+  next_branch_item = codeslayer_menu_item_new_with_label (_("next branch"));
+  gtk_widget_add_accelerator (next_branch_item, "activate", accel_group, 
+                              GDK_KEY_Down, GDK_MOD1_MASK, GTK_ACCEL_VISIBLE);
+  gtk_menu_shell_append (GTK_MENU_SHELL (submenu), next_branch_item);
   
   g_signal_connect_swapped (G_OBJECT (previous_item), "activate", 
                             G_CALLBACK (previous_action), menu);
    
   g_signal_connect_swapped (G_OBJECT (next_item), "activate", 
                             G_CALLBACK (next_action), menu);
+   
+  g_signal_connect_swapped (G_OBJECT (previous_branch_item), "activate", 
+                            G_CALLBACK (previous_branch_action), menu);
+   
+  g_signal_connect_swapped (G_OBJECT (next_branch_item), "activate", 
+                            G_CALLBACK (next_branch_action), menu);
 }
 
 static void 
@@ -126,3 +164,15 @@ next_action (NavigationMenu *menu)
 {
   g_signal_emit_by_name ((gpointer) menu, "next");
 }
+
+static void 
+previous_branch_action (NavigationMenu *menu) 
+{
+  g_signal_emit_by_name ((gpointer) menu, "previous-branch");
+}
+
+static void 
+next_branch_action (NavigationMenu *menu) 
+{
+  g_signal_emit_by_name ((gpointer) menu, "next-branch");
+}
@@ -43,6 +43,8 @@ struct _NavigationMenuClass
 
   void (*previous) (NavigationMenu *menu);
   void (*next) (NavigationMenu *menu);
+  void (*previous_branch) (NavigationMenu *menu);
+  void (*next_branch) (NavigationMenu *menu);
 };
 
 GType navigation_menu_get_type (void) G_GNUC_CONST;
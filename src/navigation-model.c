@@ -0,0 +1,865 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include "navigation-model.h"
+
+/*
+ * A list model that reads rows straight out of the engine's history instead
+ * of copying them into a GtkListStore. The model keeps its own window onto
+ * the history (the absolute index of its first row and its row count) and
+ * only moves it in navigation_model_sync, so the tree view always sees a
+ * consistent list however many changes happened in between.
+ *
+ * The model also filters itself. Rows are grouped by file as they come and
+ * go, and a query is matched against each file's name once, so only the
+ * line numbers of files whose name matched part of the query are looked at
+ * per row. While filtering the model shows a list of the matching rows, and
+ * a query that only grew is run over that list rather than every row.
+ */
+
+static void navigation_model_class_init           (NavigationModelClass *klass);
+static void navigation_model_init                 (NavigationModel      *model);
+static void navigation_model_finalize             (NavigationModel      *model);
+static void navigation_model_tree_model_init      (GtkTreeModelIface    *iface);
+
+static GtkTreeModelFlags get_flags                (GtkTreeModel         *tree_model);
+static gint get_n_columns                         (GtkTreeModel         *tree_model);
+static GType get_column_type                      (GtkTreeModel         *tree_model,
+                                                   gint                  column);
+static gboolean get_iter                          (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter,
+                                                   GtkTreePath          *path);
+static GtkTreePath* get_path                      (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter);
+static void get_value                             (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter,
+                                                   gint                  column,
+                                                   GValue               *value);
+static gboolean iter_next                         (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter);
+static gboolean iter_children                     (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter,
+                                                   GtkTreeIter          *parent);
+static gboolean iter_has_child                    (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter);
+static gint iter_n_children                       (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter);
+static gboolean iter_nth_child                    (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter,
+                                                   GtkTreeIter          *parent,
+                                                   gint                  n);
+static gboolean iter_parent                       (GtkTreeModel         *tree_model,
+                                                   GtkTreeIter          *iter,
+                                                   GtkTreeIter          *child);
+static gboolean row_matches                       (NavigationModel      *model,
+                                                   guint64               absolute);
+
+#define NAVIGATION_MODEL_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_MODEL_TYPE, NavigationModelPrivate))
+
+typedef struct _NavigationModelPrivate NavigationModelPrivate;
+
+struct _NavigationModelPrivate
+{
+  NavigationHistory       *history;
+  guint64                  offset;
+  guint                    length;
+  gint                     stamp;
+  GHashTable              *groups;
+  GPtrArray               *row_groups;
+  guint                    row_first;
+  GString                 *query;
+  GArray                  *visible;
+  guint                    visible_first;
+  NavigationModelNameFunc  name_func;
+  gpointer                 name_data;
+};
+
+/*
+ * The rows of one file, and how far the query got through its name. The
+ * match is a case insensitive subsequence match, so a query that grows
+ * carries on from offset rather than starting again.
+ */
+typedef struct
+{
+  NavigationPath *path;
+  guint           rows;
+  gsize           query_length;
+  gsize           consumed;
+  gsize           offset;
+  gboolean        line_possible;
+} Group;
+
+static void
+group_free (Group *group)
+{
+  navigation_path_unref (group->path);
+  g_slice_free (Group, group);
+}
+
+static const gchar*
+default_name (NavigationPath *path,
+              gpointer        user_data)
+{
+  return navigation_path_get_file_path (path);
+}
+
+G_DEFINE_TYPE_WITH_CODE (NavigationModel, navigation_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                navigation_model_tree_model_init))
+
+static void 
+navigation_model_class_init (NavigationModelClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) navigation_model_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationModelPrivate));
+}
+
+static void
+navigation_model_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = get_flags;
+  iface->get_n_columns = get_n_columns;
+  iface->get_column_type = get_column_type;
+  iface->get_iter = get_iter;
+  iface->get_path = get_path;
+  iface->get_value = get_value;
+  iface->iter_next = iter_next;
+  iface->iter_children = iter_children;
+  iface->iter_has_child = iter_has_child;
+  iface->iter_n_children = iter_n_children;
+  iface->iter_nth_child = iter_nth_child;
+  iface->iter_parent = iter_parent;
+}
+
+static void
+navigation_model_init (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  priv->history = NULL;
+  priv->offset = 0;
+  priv->length = 0;
+  priv->stamp = g_random_int ();
+  priv->groups = g_hash_table_new_full (g_direct_hash, g_direct_equal, 
+                                        NULL, (GDestroyNotify) group_free);
+  priv->row_groups = g_ptr_array_new ();
+  priv->row_first = 0;
+  priv->query = g_string_new (NULL);
+  priv->visible = g_array_new (FALSE, FALSE, sizeof (guint64));
+  priv->visible_first = 0;
+  priv->name_func = default_name;
+  priv->name_data = NULL;
+}
+
+static void
+navigation_model_finalize (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  g_ptr_array_free (priv->row_groups, TRUE);
+  g_hash_table_destroy (priv->groups);
+  g_string_free (priv->query, TRUE);
+  g_array_free (priv->visible, TRUE);
+  G_OBJECT_CLASS (navigation_model_parent_class)->finalize (G_OBJECT (model));
+}
+
+static void
+add_row (NavigationModel *model,
+         NavigationPath  *path)
+{
+  NavigationModelPrivate *priv;
+  Group *group;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  group = g_hash_table_lookup (priv->groups, path);
+  if (group == NULL)
+    {
+      group = g_slice_new0 (Group);
+      group->path = navigation_path_ref (path);
+      g_hash_table_insert (priv->groups, path, group);
+    }
+  
+  group->rows++;
+  g_ptr_array_add (priv->row_groups, group);
+}
+
+static void
+release_group (NavigationModel *model,
+               Group           *group)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (--group->rows == 0)
+    g_hash_table_remove (priv->groups, group->path);
+}
+
+NavigationModel*
+navigation_model_new (NavigationHistory *history)
+{
+  NavigationModelPrivate *priv;
+  NavigationModel *model;
+  guint i;
+
+  model = NAVIGATION_MODEL (g_object_new (navigation_model_get_type (), NULL));
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  priv->history = history;
+  priv->offset = navigation_history_get_offset (history);
+  priv->length = navigation_history_get_length (history);
+  
+  for (i = 0; i < priv->length; i++)
+    add_row (model, navigation_node_get_path (navigation_history_get (history, i)));
+
+  return model;
+}
+
+/*
+ * Gives the name a query is matched against, the file path by default.
+ * Call before the first query.
+ */
+void
+navigation_model_set_name_func (NavigationModel         *model,
+                                NavigationModelNameFunc  name_func,
+                                gpointer                 user_data)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  priv->name_func = name_func;
+  priv->name_data = user_data;
+}
+
+/* the number of rows shown, which is fewer than the window while filtering */
+static guint
+get_row_count (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (priv->query->len == 0)
+    return priv->length;
+  
+  return priv->visible->len - priv->visible_first;
+}
+
+static guint64
+get_row_absolute (NavigationModel *model,
+                  guint            row)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (priv->query->len == 0)
+    return priv->offset + row;
+  
+  return g_array_index (priv->visible, guint64, priv->visible_first + row);
+}
+
+NavigationNode*
+navigation_model_get_node (NavigationModel *model,
+                           GtkTreeIter     *iter)
+{
+  NavigationModelPrivate *priv;
+  gint index;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  index = navigation_model_get_index (model, iter);
+  if (index < 0)
+    return NULL;
+  
+  return navigation_history_get (priv->history, index);
+}
+
+/*
+ * The history index of the row, or -1 when the entry has already been
+ * evicted from the history but the model has not caught up yet.
+ */
+gint
+navigation_model_get_index (NavigationModel *model,
+                            GtkTreeIter     *iter)
+{
+  NavigationModelPrivate *priv;
+  guint64 absolute;
+  guint64 offset;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  g_return_val_if_fail (iter->stamp == priv->stamp, -1);
+  
+  absolute = get_row_absolute (model, GPOINTER_TO_UINT (iter->user_data));
+  offset = navigation_history_get_offset (priv->history);
+  
+  if (absolute < offset || absolute - offset >= navigation_history_get_length (priv->history))
+    return -1;
+  
+  return absolute - offset;
+}
+
+static void
+emit_row_deleted (NavigationModel *model,
+                  guint            row)
+{
+  GtkTreePath *path;
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+  gtk_tree_path_free (path);
+}
+
+static void
+remove_first_row (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  guint64 absolute;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  absolute = priv->offset;
+  priv->offset++;
+  priv->length--;
+  priv->stamp++;
+  
+  release_group (model, g_ptr_array_index (priv->row_groups, priv->row_first));
+  priv->row_first++;
+  
+  /* the front is only cut off once it makes up half the array */
+  if (priv->row_first * 2 > priv->row_groups->len)
+    {
+      g_ptr_array_remove_range (priv->row_groups, 0, priv->row_first);
+      priv->row_first = 0;
+    }
+  
+  if (priv->query->len == 0)
+    {
+      emit_row_deleted (model, 0);
+    }
+  else if (priv->visible_first < priv->visible->len && 
+           g_array_index (priv->visible, guint64, priv->visible_first) == absolute)
+    {
+      priv->visible_first++;
+      if (priv->visible_first * 2 > priv->visible->len)
+        {
+          g_array_remove_range (priv->visible, 0, priv->visible_first);
+          priv->visible_first = 0;
+        }
+      emit_row_deleted (model, 0);
+    }
+}
+
+static void
+remove_last_row (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  guint64 absolute;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  priv->length--;
+  priv->stamp++;
+  absolute = priv->offset + priv->length;
+  
+  release_group (model, g_ptr_array_index (priv->row_groups, priv->row_groups->len - 1));
+  g_ptr_array_set_size (priv->row_groups, priv->row_groups->len - 1);
+  
+  if (priv->query->len == 0)
+    {
+      emit_row_deleted (model, priv->length);
+    }
+  else if (priv->visible_first < priv->visible->len && 
+           g_array_index (priv->visible, guint64, priv->visible->len - 1) == absolute)
+    {
+      g_array_set_size (priv->visible, priv->visible->len - 1);
+      emit_row_deleted (model, get_row_count (model));
+    }
+}
+
+static void
+remove_rows (NavigationModel *model,
+             gboolean         front,
+             guint            count)
+{
+  while (count-- > 0)
+    {
+      if (front)
+        remove_first_row (model);
+      else
+        remove_last_row (model);
+    }
+}
+
+static void
+append_rows (NavigationModel *model,
+             guint            count)
+{
+  NavigationModelPrivate *priv;
+  guint64 history_offset;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  history_offset = navigation_history_get_offset (priv->history);
+  
+  while (count-- > 0)
+    {
+      GtkTreePath *path;
+      GtkTreeIter iter;
+      NavigationNode *node;
+      guint64 absolute;
+
+      absolute = priv->offset + priv->length;
+      node = navigation_history_get (priv->history, absolute - history_offset);
+      add_row (model, navigation_node_get_path (node));
+      priv->length++;
+      
+      if (priv->query->len > 0)
+        {
+          if (!row_matches (model, absolute))
+            continue;
+          g_array_append_val (priv->visible, absolute);
+        }
+
+      iter.stamp = priv->stamp;
+      iter.user_data = GUINT_TO_POINTER (get_row_count (model) - 1);
+      path = gtk_tree_path_new_from_indices (get_row_count (model) - 1, -1);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+      gtk_tree_path_free (path);
+    }
+}
+
+/*
+ * Brings the model's window in line with the history. truncated_at is the
+ * lowest absolute index the history was truncated to since the last sync
+ * (G_MAXUINT64 if it was not truncated); rows from there on are replaced.
+ */
+void
+navigation_model_sync (NavigationModel *model,
+                       guint64          truncated_at)
+{
+  NavigationModelPrivate *priv;
+  guint64 history_offset;
+  guint history_length;
+  guint64 end;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  history_offset = navigation_history_get_offset (priv->history);
+  history_length = navigation_history_get_length (priv->history);
+  
+  if (history_offset > priv->offset)
+    remove_rows (model, TRUE, MIN (history_offset - priv->offset, priv->length));
+  
+  if (priv->length == 0)
+    priv->offset = history_offset;
+  
+  end = priv->offset + priv->length;
+  if (truncated_at < end)
+    {
+      guint keep = truncated_at > priv->offset ? truncated_at - priv->offset : 0;
+      remove_rows (model, FALSE, priv->length - keep);
+    }
+  
+  if (history_length > priv->length)
+    append_rows (model, history_length - priv->length);
+}
+
+/*
+ * Takes the group's match up to the current query. Once the name has run
+ * out, a longer query gets no further in it.
+ */
+static void
+advance_match (NavigationModel *model,
+               Group           *group)
+{
+  NavigationModelPrivate *priv;
+  const gchar *query;
+  const gchar *name;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (group->query_length == priv->query->len)
+    return;
+  
+  query = priv->query->str;
+  
+  if (group->consumed == group->query_length)
+    {
+      name = priv->name_func (group->path, priv->name_data);
+      while (query[group->consumed] != '\0' && name[group->offset] != '\0')
+        {
+          if (g_ascii_tolower (name[group->offset]) == query[group->consumed])
+            group->consumed++;
+          group->offset++;
+        }
+    }
+  
+  group->query_length = priv->query->len;
+  
+  /* what the name left over can only be found in a ":line" suffix */
+  query += group->consumed;
+  group->line_possible = query[strspn (query, ":0123456789")] == '\0';
+}
+
+static void
+reset_matches (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  GHashTableIter iter;
+  Group *group;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  g_hash_table_iter_init (&iter, priv->groups);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &group))
+    {
+      group->query_length = 0;
+      group->consumed = 0;
+      group->offset = 0;
+    }
+}
+
+/*
+ * Whether remaining is a subsequence of ":line_number", without printing
+ * the number.
+ */
+static gboolean
+line_matches (const gchar *remaining,
+              gint         line_number)
+{
+  gchar digits[12];
+  gint count = 0;
+  
+  if (*remaining == ':')
+    remaining++;
+  
+  /* the digits come out lowest first */
+  line_number = MAX (line_number, 0);
+  do
+    {
+      digits[count++] = '0' + line_number % 10;
+      line_number /= 10;
+    }
+  while (line_number > 0);
+  
+  while (count > 0 && *remaining != '\0')
+    {
+      if (digits[--count] == *remaining)
+        remaining++;
+    }
+  
+  return *remaining == '\0';
+}
+
+/*
+ * A row matches when the query is a subsequence of its "name:line" text.
+ * The line is only looked at when the name matched part of the query.
+ */
+static gboolean
+row_matches (NavigationModel *model,
+             guint64          absolute)
+{
+  NavigationModelPrivate *priv;
+  NavigationNode *node;
+  Group *group;
+  guint64 history_offset;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  group = g_ptr_array_index (priv->row_groups, priv->row_first + (absolute - priv->offset));
+  advance_match (model, group);
+  
+  if (group->consumed == priv->query->len)
+    return TRUE;
+  
+  if (!group->line_possible)
+    return FALSE;
+  
+  history_offset = navigation_history_get_offset (priv->history);
+  if (absolute < history_offset || 
+      absolute - history_offset >= navigation_history_get_length (priv->history))
+    return FALSE;
+  
+  node = navigation_history_get (priv->history, absolute - history_offset);
+  
+  return line_matches (priv->query->str + group->consumed, 
+                       navigation_node_get_line_number (node));
+}
+
+/*
+ * Works out the rows to show for the current query, looking only at the
+ * rows shown for the last one when the query just grew.
+ */
+static void
+filter_rows (NavigationModel *model,
+             gboolean         narrowing)
+{
+  NavigationModelPrivate *priv;
+  GArray *visible;
+  guint64 absolute;
+  guint i;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  priv->stamp++;
+  
+  visible = g_array_new (FALSE, FALSE, sizeof (guint64));
+  
+  if (priv->query->len > 0 && narrowing)
+    {
+      for (i = priv->visible_first; i < priv->visible->len; i++)
+        {
+          absolute = g_array_index (priv->visible, guint64, i);
+          if (row_matches (model, absolute))
+            g_array_append_val (visible, absolute);
+        }
+    }
+  else if (priv->query->len > 0)
+    {
+      for (absolute = priv->offset; absolute < priv->offset + priv->length; absolute++)
+        if (row_matches (model, absolute))
+          g_array_append_val (visible, absolute);
+    }
+  
+  g_array_free (priv->visible, TRUE);
+  priv->visible = visible;
+  priv->visible_first = 0;
+}
+
+/*
+ * Shows only the rows matching query, or every row when it is empty. The
+ * query is expected in lower case. The rows are swapped without row
+ * signals, so no view may be attached while this runs.
+ */
+void
+navigation_model_set_query (NavigationModel *model,
+                            const gchar     *query)
+{
+  NavigationModelPrivate *priv;
+  gboolean narrowing;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (strcmp (query, priv->query->str) == 0)
+    return;
+  
+  narrowing = priv->query->len > 0 && g_str_has_prefix (query, priv->query->str);
+  if (!narrowing)
+    reset_matches (model);
+  
+  g_string_assign (priv->query, query);
+  filter_rows (model, narrowing);
+}
+
+/*
+ * Matches the query again from scratch, for when the names changed. The
+ * same as navigation_model_set_query, no view may be attached.
+ */
+void
+navigation_model_refilter (NavigationModel *model)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (priv->query->len == 0)
+    return;
+  
+  reset_matches (model);
+  filter_rows (model, FALSE);
+}
+
+/*
+ * The row showing the history index, or -1 when it is not shown.
+ */
+gint
+navigation_model_get_row (NavigationModel *model,
+                          gint             index)
+{
+  NavigationModelPrivate *priv;
+  guint64 absolute;
+  guint low;
+  guint high;
+  
+  priv = NAVIGATION_MODEL_GET_PRIVATE (model);
+  
+  if (index < 0)
+    return -1;
+  
+  absolute = navigation_history_get_offset (priv->history) + index;
+  if (absolute < priv->offset || absolute >= priv->offset + priv->length)
+    return -1;
+  
+  if (priv->query->len == 0)
+    return absolute - priv->offset;
+  
+  low = priv->visible_first;
+  high = priv->visible->len;
+  while (low < high)
+    {
+      guint middle = low + (high - low) / 2;
+      guint64 value = g_array_index (priv->visible, guint64, middle);
+      if (value == absolute)
+        return middle - priv->visible_first;
+      if (value < absolute)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+  
+  return -1;
+}
+
+static GtkTreeModelFlags
+get_flags (GtkTreeModel *tree_model)
+{
+  return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+get_n_columns (GtkTreeModel *tree_model)
+{
+  return NAVIGATION_MODEL_COLUMNS;
+}
+
+static GType
+get_column_type (GtkTreeModel *tree_model,
+                 gint          column)
+{
+  switch (column)
+    {
+    case NAVIGATION_MODEL_FILE_PATH:
+      return G_TYPE_STRING;
+    case NAVIGATION_MODEL_LINE_NUMBER:
+      return G_TYPE_INT;
+    }
+  return G_TYPE_INVALID;
+}
+
+static gboolean
+get_iter (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter,
+          GtkTreePath  *path)
+{
+  if (gtk_tree_path_get_depth (path) != 1)
+    return FALSE;
+  return iter_nth_child (tree_model, iter, NULL, gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath*
+get_path (GtkTreeModel *tree_model,
+          GtkTreeIter  *iter)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (tree_model);
+  g_return_val_if_fail (iter->stamp == priv->stamp, NULL);
+  return gtk_tree_path_new_from_indices (GPOINTER_TO_UINT (iter->user_data), -1);
+}
+
+static void
+get_value (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter,
+           gint          column,
+           GValue       *value)
+{
+  NavigationNode *node;
+  
+  node = navigation_model_get_node (NAVIGATION_MODEL (tree_model), iter);
+  
+  switch (column)
+    {
+    case NAVIGATION_MODEL_FILE_PATH:
+      g_value_init (value, G_TYPE_STRING);
+      if (node != NULL)
+        g_value_set_static_string (value, navigation_node_get_file_path (node));
+      break;
+    case NAVIGATION_MODEL_LINE_NUMBER:
+      g_value_init (value, G_TYPE_INT);
+      if (node != NULL)
+        g_value_set_int (value, navigation_node_get_line_number (node));
+      break;
+    }
+}
+
+static gboolean
+iter_next (GtkTreeModel *tree_model,
+           GtkTreeIter  *iter)
+{
+  guint index;
+  
+  index = GPOINTER_TO_UINT (iter->user_data) + 1;
+  if (index >= get_row_count (NAVIGATION_MODEL (tree_model)))
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+  
+  iter->user_data = GUINT_TO_POINTER (index);
+  return TRUE;
+}
+
+static gboolean
+iter_children (GtkTreeModel *tree_model,
+               GtkTreeIter  *iter,
+               GtkTreeIter  *parent)
+{
+  return iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+iter_has_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter)
+{
+  return FALSE;
+}
+
+static gint
+iter_n_children (GtkTreeModel *tree_model,
+                 GtkTreeIter  *iter)
+{
+  if (iter != NULL)
+    return 0;
+  return get_row_count (NAVIGATION_MODEL (tree_model));
+}
+
+static gboolean
+iter_nth_child (GtkTreeModel *tree_model,
+                GtkTreeIter  *iter,
+                GtkTreeIter  *parent,
+                gint          n)
+{
+  NavigationModelPrivate *priv;
+  priv = NAVIGATION_MODEL_GET_PRIVATE (tree_model);
+  
+  if (parent != NULL || n < 0 || n >= (gint) get_row_count (NAVIGATION_MODEL (tree_model)))
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+  
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (n);
+  return TRUE;
+}
+
+static gboolean
+iter_parent (GtkTreeModel *tree_model,
+             GtkTreeIter  *iter,
+             GtkTreeIter  *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_MODEL_H__
+#define __NAVIGATION_MODEL_H__
+
+#include <gtk/gtk.h>
+#include "navigation-history.h"
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_MODEL_TYPE            (navigation_model_get_type ())
+#define NAVIGATION_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_MODEL_TYPE, NavigationModel))
+#define NAVIGATION_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_MODEL_TYPE, NavigationModelClass))
+#define IS_NAVIGATION_MODEL(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_MODEL_TYPE))
+#define IS_NAVIGATION_MODEL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_MODEL_TYPE))
+
+typedef struct _NavigationModel NavigationModel;
+typedef struct _NavigationModelClass NavigationModelClass;
+
+struct _NavigationModel
+{
+  GObject parent_instance;
+};
+
+struct _NavigationModelClass
+{
+  GObjectClass parent_class;
+};
+
+enum
+{
+  NAVIGATION_MODEL_FILE_PATH,
+  NAVIGATION_MODEL_LINE_NUMBER,
+  NAVIGATION_MODEL_COLUMNS
+};
+
+typedef const gchar* (*NavigationModelNameFunc) (NavigationPath *path,
+                                                 gpointer        user_data);
+
+GType navigation_model_get_type (void) G_GNUC_CONST;
+
+NavigationModel*  navigation_model_new          (NavigationHistory *history);
+
+NavigationNode*   navigation_model_get_node     (NavigationModel   *model,
+                                                 GtkTreeIter       *iter);
+gint              navigation_model_get_index    (NavigationModel   *model,
+                                                 GtkTreeIter       *iter);
+
+void              navigation_model_sync         (NavigationModel   *model,
+                                                 guint64            truncated_at);
+
+void              navigation_model_set_name_func  (NavigationModel         *model,
+                                                   NavigationModelNameFunc  name_func,
+                                                   gpointer                 user_data);
+void              navigation_model_set_query      (NavigationModel         *model,
+                                                   const gchar             *query);
+void              navigation_model_refilter       (NavigationModel         *model);
+gint              navigation_model_get_row        (NavigationModel         *model,
+                                                   gint                     index);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_MODEL_H__ */
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_NODE_PRIVATE_H__
+#define __NAVIGATION_NODE_PRIVATE_H__
+
+#include "navigation-node.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Only for the node itself and the history that keeps nodes in its slabs;
+ * everything else goes through the accessors.
+ */
+struct _NavigationNode
+{
+  NavigationPath *path;
+  gint            line_number;
+  gint64          timestamp;
+  GtkTextMark    *mark;
+  guint32         fingerprint;
+  gboolean        origin;
+};
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_NODE_PRIVATE_H__ */
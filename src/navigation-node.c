@@ -16,113 +16,183 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
-#include "navigation-node.h"
 
-static void navigation_node_class_init    (NavigationNodeClass *klass);
-static void navigation_node_init          (NavigationNode      *node);
-static void navigation_node_finalize      (NavigationNode      *node);
+#include "navigation-node-private.h"
 
-#define NAVIGATION_NODE_GET_PRIVATE(obj) \
-  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_NODE_TYPE, NavigationNodePrivate))
+static void
+drop_mark (NavigationNode *node)
+{
+  GtkTextBuffer *buffer;
 
-typedef struct _NavigationNodePrivate NavigationNodePrivate;
+  if (node->mark == NULL)
+    return;
+
+  if (!gtk_text_mark_get_deleted (node->mark))
+    {
+      buffer = gtk_text_mark_get_buffer (node->mark);
+      gtk_text_buffer_delete_mark (buffer, node->mark);
+    }
+
+  g_object_unref (node->mark);
+  node->mark = NULL;
+}
 
-struct _NavigationNodePrivate
+void
+navigation_node_set (NavigationNode *node,
+                     NavigationPath *path,
+                     gint            line_number)
 {
-  gchar *file_path;
-  gint   line_number;
-};
+  navigation_path_ref (path);
+  if (node->path != NULL)
+    navigation_path_unref (node->path);
+  drop_mark (node);
+  node->path = path;
+  node->line_number = line_number;
+  node->timestamp = g_get_real_time ();
+  node->fingerprint = 0;
+  node->origin = FALSE;
+}
 
-G_DEFINE_TYPE (NavigationNode, navigation_node, G_TYPE_OBJECT)
+void
+navigation_node_clear (NavigationNode *node)
+{
+  if (node->path != NULL)
+    navigation_path_unref (node->path);
+  drop_mark (node);
+  node->path = NULL;
+  node->line_number = 0;
+  node->timestamp = 0;
+  node->fingerprint = 0;
+  node->origin = FALSE;
+}
 
-enum
+void
+navigation_node_anchor (NavigationNode *node,
+                        GtkTextBuffer  *buffer)
 {
-  PROP_0,
-  PROP_FILE_PATH,
-  PROP_LINE_NUMBER
-};
+  GtkTextIter iter;
+
+  drop_mark (node);
 
-static void 
-navigation_node_class_init (NavigationNodeClass *klass)
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, MAX (node->line_number, 1) - 1);
+
+  /* right gravity, so text typed at the start of the line pushes it down */
+  node->mark = gtk_text_buffer_create_mark (buffer, NULL, &iter, FALSE);
+  g_object_ref (node->mark);
+}
+
+/*
+ * Copies the line back from the mark and lets go of it. Called while the
+ * buffer is still alive, as a deleted mark no longer knows its line.
+ */
+void
+navigation_node_release_anchor (NavigationNode *node)
 {
-  G_OBJECT_CLASS (klass)->finalize = (GObjectFinalizeFunc) navigation_node_finalize;
-  g_type_class_add_private (klass, sizeof (NavigationNodePrivate));
+  node->line_number = navigation_node_get_line_number (node);
+  drop_mark (node);
 }
 
-static void
-navigation_node_init (NavigationNode *node)
+gboolean
+navigation_node_is_anchored (NavigationNode *node)
 {
-  NavigationNodePrivate *priv;
-  priv = NAVIGATION_NODE_GET_PRIVATE (node);
-  priv->file_path = NULL;
+  return node->mark != NULL;
 }
 
-static void
-navigation_node_finalize (NavigationNode *node)
+/*
+ * The buffer the node is anchored to, or NULL when it is not.
+ */
+GtkTextBuffer *
+navigation_node_get_buffer (NavigationNode *node)
 {
-  NavigationNodePrivate *priv;
-  priv = NAVIGATION_NODE_GET_PRIVATE (node);
+  if (node->mark == NULL || gtk_text_mark_get_deleted (node->mark))
+    return NULL;
+  return gtk_text_mark_get_buffer (node->mark);
+}
 
-  if (priv->file_path != NULL)
-    g_free (priv->file_path);
-      
-  G_OBJECT_CLASS (navigation_node_parent_class)->finalize (G_OBJECT (node));
+NavigationPath *
+navigation_node_get_path (NavigationNode *node)
+{
+  return node->path;
 }
 
-NavigationNode *
-navigation_node_new (void)
+const gchar *
+navigation_node_get_file_path (NavigationNode *node)
 {
-  return NAVIGATION_NODE (g_object_new (navigation_node_get_type (), NULL));
+  if (node->path == NULL)
+    return NULL;
+  return navigation_path_get_file_path (node->path);
 }
 
-const gint
+gint
 navigation_node_get_line_number (NavigationNode *node)
 {
-  return NAVIGATION_NODE_GET_PRIVATE (node)->line_number;
+  GtkTextIter iter;
+
+  if (node->mark == NULL || gtk_text_mark_get_deleted (node->mark))
+    return node->line_number;
+
+  gtk_text_buffer_get_iter_at_mark (gtk_text_mark_get_buffer (node->mark), &iter, node->mark);
+  return gtk_text_iter_get_line (&iter) + 1;
 }
 
 void
 navigation_node_set_line_number (NavigationNode *node,
-                                 const gint      line_number)
+                                 gint            line_number)
 {
-  NavigationNodePrivate *priv;
-  priv = NAVIGATION_NODE_GET_PRIVATE (node);
-  priv->line_number = line_number;
+  node->line_number = line_number;
 }
 
-const gchar *
-navigation_node_get_file_path (NavigationNode *node)
+guint32
+navigation_node_get_fingerprint (NavigationNode *node)
 {
-  return NAVIGATION_NODE_GET_PRIVATE (node)->file_path;
+  return node->fingerprint;
 }
 
 void
-navigation_node_set_file_path (NavigationNode *node,
-                               const gchar    *file_path)
+navigation_node_set_fingerprint (NavigationNode *node,
+                                 guint32         fingerprint)
 {
-  NavigationNodePrivate *priv;
-  priv = NAVIGATION_NODE_GET_PRIVATE (node);
-  if (priv->file_path)
-    {
-      g_free (priv->file_path);
-      priv->file_path = NULL;
-    }
-  priv->file_path = g_strdup (file_path);
+  node->fingerprint = fingerprint;
+}
+
+gint64
+navigation_node_get_timestamp (NavigationNode *node)
+{
+  return node->timestamp;
+}
+
+/*
+ * For replaying a journal, where the node was made long before.
+ */
+void
+navigation_node_set_timestamp (NavigationNode *node,
+                               gint64          timestamp)
+{
+  node->timestamp = timestamp;
+}
+
+/*
+ * Whether the node only records where a jump started from, rather than a
+ * place that was navigated to.
+ */
+gboolean
+navigation_node_is_origin (NavigationNode *node)
+{
+  return node->origin;
+}
+
+void
+navigation_node_set_origin (NavigationNode *node,
+                            gboolean        origin)
+{
+  node->origin = origin;
 }
 
 gboolean
 navigation_node_equals (NavigationNode *node, 
-                        NavigationNode *that)
-{
-  NavigationNodePrivate *priv;
-  const gchar *file_path;
-  gint line_number;
-  
-  priv = NAVIGATION_NODE_GET_PRIVATE (node);
-  
-  file_path = navigation_node_get_file_path (that);
-  line_number = navigation_node_get_line_number (that);
-  
-  return g_strcmp0 (file_path, priv->file_path) == 0 && 
-         line_number == priv->line_number;
+                        NavigationPath *path,
+                        gint            line_number)
+{
+  return node->path == path && 
+         navigation_node_get_line_number (node) == line_number;
 }                        
@@ -16,46 +16,54 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
+
 #ifndef __NAVIGATION_NODE_H__
 #define __NAVIGATION_NODE_H__
 
 #include <gtk/gtk.h>
-#include <codeslayer/codeslayer-project.h>
+#include "navigation-path.h"
 
 G_BEGIN_DECLS
 
-#define NAVIGATION_NODE_TYPE            (navigation_node_get_type ())
-#define NAVIGATION_NODE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_NODE_TYPE, NavigationNode))
-#define NAVIGATION_NODE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_NODE_TYPE, NavigationNodeClass))
-#define IS_NAVIGATION_NODE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_NODE_TYPE))
-#define IS_NAVIGATION_NODE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_NODE_TYPE))
-
+/*
+ * A plain navigation entry. Nodes are stored by value in the slots of the
+ * NavigationHistory that owns them; the node holds a reference on its path.
+ *
+ * While the file is open a node can be anchored to a mark in its buffer, so
+ * edits above it move it along. The line number is only read back from the
+ * mark when the anchor is released.
+ */
 typedef struct _NavigationNode NavigationNode;
-typedef struct _NavigationNodeClass NavigationNodeClass;
-
-struct _NavigationNode
-{
-  GObject parent_instance;
-};
-
-struct _NavigationNodeClass
-{
-  GObjectClass parent_class;
-};
 
-GType navigation_node_get_type (void) G_GNUC_CONST;
+void             navigation_node_set              (NavigationNode *node,
+                                                   NavigationPath *path,
+                                                   gint            line_number);
+void             navigation_node_clear            (NavigationNode *node);
 
-NavigationNode*  navigation_node_new (void);
+void             navigation_node_anchor           (NavigationNode *node,
+                                                   GtkTextBuffer  *buffer);
+void             navigation_node_release_anchor   (NavigationNode *node);
+gboolean         navigation_node_is_anchored      (NavigationNode *node);
+GtkTextBuffer*   navigation_node_get_buffer       (NavigationNode *node);
 
+NavigationPath*  navigation_node_get_path         (NavigationNode *node);
 const gchar*     navigation_node_get_file_path    (NavigationNode *node);
-void             navigation_node_set_file_path    (NavigationNode *node, 
-                                                   const gchar    *file_path);
-const gint       navigation_node_get_line_number  (NavigationNode *node);
-void             navigation_node_set_line_number  (NavigationNode *node, 
-                                                   const gint      line_number);
+gint             navigation_node_get_line_number  (NavigationNode *node);
+void             navigation_node_set_line_number  (NavigationNode *node,
+                                                   gint            line_number);
+guint32          navigation_node_get_fingerprint  (NavigationNode *node);
+void             navigation_node_set_fingerprint  (NavigationNode *node,
+                                                   guint32         fingerprint);
+gint64           navigation_node_get_timestamp    (NavigationNode *node);
+void             navigation_node_set_timestamp    (NavigationNode *node,
+                                                   gint64          timestamp);
+gboolean         navigation_node_is_origin        (NavigationNode *node);
+void             navigation_node_set_origin       (NavigationNode *node,
+                                                   gboolean        origin);
 
 gboolean         navigation_node_equals           (NavigationNode *node, 
-                                                   NavigationNode *that);
+                                                   NavigationPath *path,
+                                                   gint            line_number);
 
 G_END_DECLS
 
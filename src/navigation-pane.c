@@ -21,17 +21,48 @@
 #include <gtksourceview/gtksourceview.h>
 #include "navigation-pane.h"
 #include "navigation-node.h"
+#include "navigation-model.h"
+#include "navigation-hotspots.h"
+#include "navigation-snippets.h"
+#include "navigation-probes.h"
 
 static void navigation_pane_class_init  (NavigationPaneClass *klass);
 static void navigation_pane_init        (NavigationPane      *pane);
 static void navigation_pane_finalize    (NavigationPane      *pane);
-
-static gchar* get_text_name             (CodeSlayer          *codeslayer, 
-                                         const gchar         *file_path,
-                                         gint                 line_number);
+static void navigation_pane_map         (GtkWidget           *widget);
+
+static const gchar* get_display_name    (NavigationPane      *pane, 
+                                         NavigationPath      *path);
+static void projects_changed_action     (NavigationPane      *pane);
+static void select_position             (NavigationPane      *pane,
+                                         gint                 position);
+static void render_text                 (GtkTreeViewColumn   *column,
+                                         GtkCellRenderer     *renderer,
+                                         GtkTreeModel        *model,
+                                         GtkTreeIter         *iter,
+                                         NavigationPane      *pane);
+static void render_snippet              (GtkTreeViewColumn   *column,
+                                         GtkCellRenderer     *renderer,
+                                         GtkTreeModel        *model,
+                                         GtkTreeIter         *iter,
+                                         NavigationPane      *pane);
+static gboolean start_draw              (NavigationPane      *pane);
 static gboolean select_path             (NavigationPane      *pane, 
                                          GtkTreeIter         *treeiter, 
                                          GtkTreeViewColumn   *column);
+static void filter_changed              (NavigationPane      *pane);
+static void apply_filter                (NavigationPane      *pane);
+static void clear_filter                (NavigationPane      *pane);
+static const gchar* filter_name         (NavigationPath      *path,
+                                         NavigationPane      *pane);
+static void build                       (NavigationPane      *pane);
+static NavigationModel* get_model       (NavigationPane      *pane,
+                                         NavigationHistory   *history);
+static void add_hotspots                (NavigationPane      *pane);
+static void refresh_hotspots            (NavigationPane      *pane);
+static void select_hotspot              (NavigationPane      *pane, 
+                                         GtkTreePath         *tree_path, 
+                                         GtkTreeViewColumn   *column);
 
 #define NAVIGATION_PANE_GET_PRIVATE(obj) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_PANE_TYPE, NavigationPanePrivate))
@@ -40,18 +71,22 @@ typedef struct _NavigationPanePrivate NavigationPanePrivate;
 
 struct _NavigationPanePrivate
 {
-  CodeSlayer   *codeslayer;
-  GtkWidget    *tree;
-  GtkListStore *store;
-};
-
-enum
-{
-  TEXT,
-  FILE_PATH,
-  LINE_NUMBER,
-  POSITION,
-  COLUMNS
+  CodeSlayer        *codeslayer;
+  GtkWidget         *tree;
+  NavigationHistory *history;
+  NavigationModel   *model;
+  GHashTable        *models;
+  GString           *text;
+  guint              display_generation;
+  gulong             projects_changed_id;
+  GtkWidget         *entry;
+  GString           *query;
+  NavigationHotspots *hotspots;
+  GtkWidget         *hotspots_expander;
+  GtkListStore      *hotspots_store;
+  guint              hotspots_stamp;
+  NavigationSnippets *snippets;
+  gboolean           built;
 };
 
 G_DEFINE_TYPE (NavigationPane, navigation_pane, GTK_TYPE_VBOX)
@@ -59,6 +94,7 @@ G_DEFINE_TYPE (NavigationPane, navigation_pane, GTK_TYPE_VBOX)
 enum
 {
   SELECT_POSITION,
+  SELECT_LOCATION,
   LAST_SIGNAL
 };
 
@@ -68,6 +104,7 @@ static void
 navigation_pane_class_init (NavigationPaneClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   
   navigation_pane_signals[SELECT_POSITION] =
     g_signal_new ("select-position", 
@@ -77,42 +114,109 @@ navigation_pane_class_init (NavigationPaneClass *klass)
                   NULL, NULL,
                   g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
   
+  navigation_pane_signals[SELECT_LOCATION] =
+    g_signal_new ("select-location", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationPaneClass, select_location), 
+                  NULL, NULL,
+                  g_cclosure_marshal_generic, G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_INT);
+  
+  widget_class->map = navigation_pane_map;
   gobject_class->finalize = (GObjectFinalizeFunc) navigation_pane_finalize;
   g_type_class_add_private (klass, sizeof (NavigationPanePrivate));
 }
 
+/*
+ * Only the bookkeeping is set up here. The widgets wait until the pane is
+ * first shown, which may be never if the side pane stays closed.
+ */
 static void
 navigation_pane_init (NavigationPane *pane) 
 {
   NavigationPanePrivate *priv;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  priv->tree = NULL;
+  priv->model = NULL;
+  priv->models = g_hash_table_new_full (g_direct_hash, g_direct_equal, 
+                                        NULL, (GDestroyNotify) g_object_unref);
+  priv->text = g_string_new (NULL);
+  priv->display_generation = 1;
+  priv->entry = NULL;
+  priv->query = g_string_new (NULL);
+  priv->hotspots = NULL;
+  priv->hotspots_expander = NULL;
+  priv->hotspots_store = NULL;
+  priv->hotspots_stamp = 0;
+  priv->snippets = NULL;
+  priv->built = FALSE;
+}
+
+static void
+navigation_pane_map (GtkWidget *widget)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (widget);
+  
+  if (!priv->built)
+    build (NAVIGATION_PANE (widget));
+  
+  GTK_WIDGET_CLASS (navigation_pane_parent_class)->map (widget);
+}
 
+static void
+build (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
   GtkWidget *tree;
-  GtkListStore *store;
   GtkTreeViewColumn *column;
   GtkCellRenderer *renderer;
   GtkTreeSelection *selection;
   GtkWidget *scrolled_window;
+  GtkWidget *entry;
+  gint64 started;
   
   priv = NAVIGATION_PANE_GET_PRIVATE (pane);
   
+  started = g_get_monotonic_time ();
+  priv->built = TRUE;
+  
   tree = gtk_tree_view_new ();
   priv->tree = tree;
-  store = gtk_list_store_new (COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT, G_TYPE_INT);
-  priv->store = store;
   gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tree), FALSE);
-  gtk_tree_view_set_model (GTK_TREE_VIEW (tree), GTK_TREE_MODEL (store));
-  g_object_unref (store);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree), TRUE);
                            
   selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (tree));
   gtk_tree_selection_set_mode (selection, GTK_SELECTION_SINGLE);
 
   column = gtk_tree_view_column_new ();
+  gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
   renderer = gtk_cell_renderer_text_new ();
   gtk_tree_view_column_pack_start (column, renderer, FALSE);
-  gtk_tree_view_column_set_attributes (column, renderer, "text", TEXT, NULL);
+  gtk_tree_view_column_set_cell_data_func (column, renderer, 
+                                           (GtkTreeCellDataFunc) render_text, 
+                                           pane, NULL);
+  
+  renderer = gtk_cell_renderer_text_new ();
+  g_object_set (renderer, 
+                "foreground", "gray", 
+                "ellipsize", PANGO_ELLIPSIZE_END, 
+                NULL);
+  gtk_tree_view_column_pack_start (column, renderer, TRUE);
+  gtk_tree_view_column_set_cell_data_func (column, renderer, 
+                                           (GtkTreeCellDataFunc) render_snippet, 
+                                           pane, NULL);
 
   gtk_tree_view_append_column (GTK_TREE_VIEW (tree), column);
 
+  entry = gtk_entry_new ();
+  priv->entry = entry;
+  gtk_entry_set_placeholder_text (GTK_ENTRY (entry), _("Filter"));
+  gtk_entry_set_icon_from_stock (GTK_ENTRY (entry), GTK_ENTRY_ICON_SECONDARY, GTK_STOCK_CLEAR);
+  gtk_box_pack_start (GTK_BOX (pane), entry, FALSE, FALSE, 0);
+
   scrolled_window = gtk_scrolled_window_new (NULL, NULL);
   gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window),
                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
@@ -122,16 +226,97 @@ navigation_pane_init (NavigationPane *pane)
 
   g_signal_connect_swapped (G_OBJECT (tree), "row_activated",
                             G_CALLBACK (select_path), pane);
+  
+  g_signal_connect_swapped (G_OBJECT (entry), "changed",
+                            G_CALLBACK (filter_changed), pane);
+  
+  g_signal_connect_swapped (G_OBJECT (entry), "icon-press",
+                            G_CALLBACK (clear_filter), pane);
+  
+  add_hotspots (pane);
+  
+  priv->snippets = navigation_snippets_new ();
+  g_signal_connect_swapped (G_OBJECT (priv->snippets), "changed",
+                            G_CALLBACK (gtk_widget_queue_draw), tree);
+  g_signal_connect_swapped (G_OBJECT (tree), "draw",
+                            G_CALLBACK (start_draw), pane);
+  
+  priv->model = get_model (pane, priv->history);
+  gtk_tree_view_set_model (GTK_TREE_VIEW (tree), GTK_TREE_MODEL (priv->model));
+  
+  gtk_widget_show_all (entry);
+  gtk_widget_show_all (scrolled_window);
+  gtk_widget_show_all (priv->hotspots_expander);
+  
+  select_position (pane, navigation_history_get_position (priv->history));
+  
+  g_debug ("navigation: pane built in %.1f ms", 
+           (g_get_monotonic_time () - started) / 1000.0);
+}
+
+enum
+{
+  HOTSPOT_TEXT,
+  HOTSPOT_FILE_PATH,
+  HOTSPOT_LINE_NUMBER,
+  HOTSPOT_COLUMNS
+};
+
+#define TOP_HOTSPOTS 10
+
+static void
+add_hotspots (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  GtkWidget *tree;
+  GtkTreeViewColumn *column;
+  GtkCellRenderer *renderer;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  priv->hotspots_store = gtk_list_store_new (HOTSPOT_COLUMNS, G_TYPE_STRING, 
+                                             G_TYPE_STRING, G_TYPE_INT);
+  
+  tree = gtk_tree_view_new_with_model (GTK_TREE_MODEL (priv->hotspots_store));
+  gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tree), FALSE);
+  
+  renderer = gtk_cell_renderer_text_new ();
+  column = gtk_tree_view_column_new_with_attributes (NULL, renderer, 
+                                                     "text", HOTSPOT_TEXT, NULL);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (tree), column);
+  
+  priv->hotspots_expander = gtk_expander_new (_("Frequent Locations"));
+  gtk_container_add (GTK_CONTAINER (priv->hotspots_expander), tree);
+  
+  gtk_box_pack_start (GTK_BOX (pane), priv->hotspots_expander, FALSE, FALSE, 0);
+  
+  g_signal_connect_swapped (G_OBJECT (tree), "row_activated",
+                            G_CALLBACK (select_hotspot), pane);
+  
+  g_signal_connect_swapped (G_OBJECT (priv->hotspots_expander), "notify::expanded",
+                            G_CALLBACK (refresh_hotspots), pane);
 }
 
 static void
 navigation_pane_finalize (NavigationPane *pane)
 {
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  g_hash_table_destroy (priv->models);
+  g_signal_handler_disconnect (priv->codeslayer, priv->projects_changed_id);
+  g_string_free (priv->text, TRUE);
+  if (priv->hotspots_store != NULL)
+    g_object_unref (priv->hotspots_store);
+  if (priv->snippets != NULL)
+    g_object_unref (priv->snippets);
+  g_string_free (priv->query, TRUE);
   G_OBJECT_CLASS (navigation_pane_parent_class)->finalize (G_OBJECT(pane));
 }
 
 GtkWidget*
-navigation_pane_new (CodeSlayer *codeslayer)
+navigation_pane_new (CodeSlayer         *codeslayer,
+                     NavigationHistory  *history,
+                     NavigationHotspots *hotspots)
 {
   NavigationPanePrivate *priv;
   GtkWidget *pane;
@@ -139,91 +324,390 @@ navigation_pane_new (CodeSlayer *codeslayer)
   pane = g_object_new (navigation_pane_get_type (), NULL);
   priv = NAVIGATION_PANE_GET_PRIVATE (pane);
   priv->codeslayer = codeslayer;
+  priv->history = history;
+  priv->hotspots = hotspots;
+  
+  priv->projects_changed_id = g_signal_connect_swapped (G_OBJECT (codeslayer), "projects-changed", 
+                                                        G_CALLBACK (projects_changed_action), pane);
   
   return pane;
 }                                 
 
-void 
-navigation_pane_refresh_path (NavigationPane *pane, 
-                              GList          *path, 
-                              gint            position)
+void
+navigation_pane_refresh (NavigationPane *pane,
+                         guint64         truncated_at)
 {
   NavigationPanePrivate *priv;
-  GtkTreeSelection *selection;
-  GtkTreeIter iter;
-  gint length;
-  guint i = 0;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  /* a model built later starts out in step with the history */
+  if (!priv->built)
+    return;
+  
+  NAVIGATION_PROBE_NODE (pane__refresh__begin, navigation_history_get_current (priv->history));
+  
+  navigation_model_sync (priv->model, truncated_at);
+  gtk_widget_queue_draw (priv->tree);
+  select_position (pane, navigation_history_get_position (priv->history));
+  refresh_hotspots (pane);
+  
+  NAVIGATION_PROBE_NODE (pane__refresh__end, navigation_history_get_current (priv->history));
+}
+
+/*
+ * Each history keeps its model for as long as the pane lives, so coming back
+ * to a history only has to catch up with what changed while it was away.
+ */
+static NavigationModel*
+get_model (NavigationPane    *pane,
+           NavigationHistory *history)
+{
+  NavigationPanePrivate *priv;
+  NavigationModel *model;
   
   priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  model = g_hash_table_lookup (priv->models, history);
+  if (model == NULL)
+    {
+      model = navigation_model_new (history);
+      navigation_model_set_name_func (model, (NavigationModelNameFunc) filter_name, pane);
+      g_hash_table_insert (priv->models, history, model);
+    }
+  
+  return model;
+}
 
-  if (priv->store != NULL)
-    gtk_list_store_clear (priv->store);
+/*
+ * Swaps in another history by handing the view that history's model. The
+ * rows are brought up to date and the position selected by the refresh that
+ * follows. The model only has to filter itself again if the query changed
+ * while it was away.
+ */
+void
+navigation_pane_set_history (NavigationPane    *pane,
+                             NavigationHistory *history)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
   
-  length = g_list_length (path);
+  priv->history = history;
   
-  selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->tree));
+  if (!priv->built)
+    return;
+  
+  priv->model = get_model (pane, history);
+  apply_filter (pane);
+}
+
+/*
+ * The list is only rebuilt while it can be seen and the ranking has moved
+ * since it was last built.
+ */
+static void
+refresh_hotspots (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  NavigationHotspot *top[TOP_HOTSPOTS];
+  guint stamp;
+  guint count;
+  guint i;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
   
-  for (; i < length; ++i)
+  if (priv->hotspots == NULL || priv->hotspots_expander == NULL || 
+      !gtk_expander_get_expanded (GTK_EXPANDER (priv->hotspots_expander)))
+    return;
+  
+  stamp = navigation_hotspots_get_stamp (priv->hotspots);
+  if (stamp == priv->hotspots_stamp)
+    return;
+  
+  priv->hotspots_stamp = stamp;
+  
+  gtk_list_store_clear (priv->hotspots_store);
+
+  count = navigation_hotspots_get_top (priv->hotspots, top, TOP_HOTSPOTS);
+  for (i = 0; i < count; i++)
     {
-      NavigationNode *node = g_list_nth_data (path, i);
-      const gchar *file_path;
-      gchar *text_name;
+      NavigationPath *path;
+      GtkTreeIter iter;
       gint line_number;
       
-      file_path = navigation_node_get_file_path (node);
-      line_number = navigation_node_get_line_number (node);
-      text_name = get_text_name (priv->codeslayer, file_path, line_number);
-
-      gtk_list_store_append (priv->store, &iter);
-
-      if (position == i)
-        {
-          gtk_list_store_set (priv->store, &iter,
-                              TEXT, text_name, 
-                              FILE_PATH, file_path, 
-                              LINE_NUMBER, line_number,
-                              POSITION, i, -1);
-
-          gtk_tree_selection_select_iter (selection, &iter);
-        }
-      else
-        {
-          gtk_list_store_set (priv->store, &iter,
-                              TEXT, text_name, 
-                              FILE_PATH, file_path, 
-                              LINE_NUMBER, line_number,
-                              POSITION, i, -1);
-        }
-        
-      g_free (text_name);
+      path = navigation_hotspot_get_path (top[i]);
+      line_number = navigation_hotspot_get_line_number (top[i]);
+      
+      g_string_printf (priv->text, "%s:%d  (%u visits)", 
+                       get_display_name (pane, path), line_number, 
+                       navigation_hotspot_get_visit_count (top[i]));
+      
+      gtk_list_store_insert_with_values (priv->hotspots_store, &iter, -1,
+                                         HOTSPOT_TEXT, priv->text->str, 
+                                         HOTSPOT_FILE_PATH, navigation_path_get_file_path (path),
+                                         HOTSPOT_LINE_NUMBER, line_number, 
+                                         -1);
     }
 }
 
-static gchar*
-get_text_name (CodeSlayer  *codeslayer, 
-               const gchar *file_path,
-               gint         line_number)
+static void
+select_hotspot (NavigationPane    *pane, 
+                GtkTreePath       *tree_path, 
+                GtkTreeViewColumn *column)
 {
+  NavigationPanePrivate *priv;
+  GtkTreeIter iter;
+  gchar *file_path;
+  gint line_number;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+
+  if (!gtk_tree_model_get_iter (GTK_TREE_MODEL (priv->hotspots_store), &iter, tree_path))
+    return;
+  
+  gtk_tree_model_get (GTK_TREE_MODEL (priv->hotspots_store), &iter, 
+                      HOTSPOT_FILE_PATH, &file_path, 
+                      HOTSPOT_LINE_NUMBER, &line_number, 
+                      -1);
+  
+  g_signal_emit_by_name ((gpointer) pane, "select-location", file_path, line_number);
+  
+  g_free (file_path);
+}
+
+static void
+select_position (NavigationPane *pane,
+                 gint            position)
+{
+  NavigationPanePrivate *priv;
+  GtkTreeSelection *selection;
+  GtkTreeIter iter;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->tree));
+  
+  if (!gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (priv->model), &iter, NULL, 
+                                      navigation_model_get_row (priv->model, position)))
+    {
+      gtk_tree_selection_unselect_all (selection);
+      return;
+    }
+  
+  gtk_tree_selection_select_iter (selection, &iter);
+}
+
+static const gchar*
+get_display_name (NavigationPane *pane, 
+                  NavigationPath *path)
+{
+  NavigationPanePrivate *priv;
   CodeSlayerProject *project;
-  const gchar *folder_path;
-  const gchar *project_name;
-  gchar *substr;
+  const gchar *display_name;
+  const gchar *file_path;
   gchar *result;
   
-  project = codeslayer_get_project_by_file_path (codeslayer, file_path);
-  project_name = codeslayer_project_get_name (project);
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  display_name = navigation_path_get_display_name (path, priv->display_generation);
+  if (display_name != NULL)
+    return display_name;
 
-  folder_path = codeslayer_project_get_folder_path (project);
+  file_path = navigation_path_get_file_path (path);
+  project = codeslayer_get_project_by_file_path (priv->codeslayer, file_path);
   
-  substr = codeslayer_utils_substr (file_path, strlen(folder_path) + 1, strlen(file_path));
+  if (project != NULL)
+    {
+      const gchar *folder_path;
+      const gchar *project_name;
+      gsize folder_length;
 
-  result = g_strdup_printf ("%s - %s:%d", project_name, substr, line_number);
+      project_name = codeslayer_project_get_name (project);
+      folder_path = codeslayer_project_get_folder_path (project);
+      folder_length = strlen (folder_path);
+      
+      if (strncmp (file_path, folder_path, folder_length) == 0 && 
+          file_path[folder_length] == G_DIR_SEPARATOR)
+        result = g_strdup_printf ("%s - %s", project_name, file_path + folder_length + 1);
+      else
+        result = g_strdup_printf ("%s - %s", project_name, file_path);
+    }
+  else
+    {
+      result = g_strdup (file_path);
+    }
     
-  g_free (substr);
+  navigation_path_set_display_name (path, result, priv->display_generation);
   
   return result;
 }
 
+static const gchar*
+filter_name (NavigationPath *path,
+             NavigationPane *pane)
+{
+  return get_display_name (pane, path);
+}
+
+/*
+ * The tree view is detached while the model filters itself, so it reads
+ * the new rows once rather than follow a row signal for each.
+ */
+static void
+apply_filter (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree), NULL);
+  navigation_model_set_query (priv->model, priv->query->str);
+  gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree), GTK_TREE_MODEL (priv->model));
+  
+  select_position (pane, navigation_history_get_position (priv->history));
+}
+
+static void
+filter_changed (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  gchar *query;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  query = g_ascii_strdown (gtk_entry_get_text (GTK_ENTRY (priv->entry)), -1);
+  
+  if (g_strcmp0 (query, priv->query->str) == 0)
+    {
+      g_free (query);
+      return;
+    }
+  
+  g_string_assign (priv->query, query);
+  g_free (query);
+  
+  apply_filter (pane);
+}
+
+static void
+clear_filter (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  gtk_entry_set_text (GTK_ENTRY (priv->entry), "");
+}
+
+static void
+projects_changed_action (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  priv->display_generation++;
+  
+  if (!priv->built)
+    return;
+  
+  gtk_widget_queue_draw (priv->tree);
+  priv->hotspots_stamp--;
+  refresh_hotspots (pane);
+  
+  if (priv->query->len > 0)
+    {
+      GHashTableIter iter;
+      gpointer model;
+      
+      /* the hidden models match again from scratch when shown */
+      g_hash_table_iter_init (&iter, priv->models);
+      while (g_hash_table_iter_next (&iter, NULL, &model))
+        if (model != priv->model)
+          navigation_model_set_query (model, "");
+      
+      gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree), NULL);
+      navigation_model_refilter (priv->model);
+      gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree), GTK_TREE_MODEL (priv->model));
+      select_position (pane, navigation_history_get_position (priv->history));
+    }
+}
+
+static void
+render_text (GtkTreeViewColumn *column,
+             GtkCellRenderer   *renderer,
+             GtkTreeModel      *model,
+             GtkTreeIter       *iter,
+             NavigationPane    *pane)
+{
+  NavigationPanePrivate *priv;
+  NavigationNode *node;
+  guint branches;
+  gint index;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  index = navigation_model_get_index (NAVIGATION_MODEL (model), iter);
+  if (index < 0)
+    {
+      g_object_set (renderer, "text", NULL, NULL);
+      return;
+    }
+  
+  node = navigation_history_get (priv->history, index);
+  
+  g_string_printf (priv->text, "%s:%d", 
+                   get_display_name (pane, navigation_node_get_path (node)),
+                   navigation_node_get_line_number (node));
+  
+  branches = navigation_history_get_branch_count (priv->history, index);
+  if (branches > 1)
+    g_string_append_printf (priv->text, "  (%u branches)", branches);
+  
+  /* entries whose file is gone stay, greyed out */
+  g_object_set (renderer, 
+                "text", priv->text->str, 
+                "sensitive", !navigation_path_get_missing (navigation_node_get_path (node)), 
+                NULL);
+}
+
+static gboolean
+start_draw (NavigationPane *pane)
+{
+  NavigationPanePrivate *priv;
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  navigation_snippets_start_draw (priv->snippets);
+  return FALSE;
+}
+
+/*
+ * Only called for the rows on screen, so only their files are indexed.
+ */
+static void
+render_snippet (GtkTreeViewColumn *column,
+                GtkCellRenderer   *renderer,
+                GtkTreeModel      *model,
+                GtkTreeIter       *iter,
+                NavigationPane    *pane)
+{
+  NavigationPanePrivate *priv;
+  NavigationNode *node;
+  const gchar *snippet = NULL;
+  gint index;
+  
+  priv = NAVIGATION_PANE_GET_PRIVATE (pane);
+  
+  index = navigation_model_get_index (NAVIGATION_MODEL (model), iter);
+  if (index < 0)
+    {
+      g_object_set (renderer, "text", NULL, NULL);
+      return;
+    }
+  
+  node = navigation_history_get (priv->history, index);
+  
+  if (!navigation_path_get_missing (navigation_node_get_path (node)))
+    snippet = navigation_snippets_get (priv->snippets, 
+                                       navigation_node_get_file_path (node), 
+                                       navigation_node_get_line_number (node));
+  
+  g_object_set (renderer, "text", snippet, NULL);
+}
+
 static gboolean
 select_path (NavigationPane    *pane, 
              GtkTreeIter       *treeiter, 
@@ -239,20 +723,11 @@ select_path (NavigationPane    *pane,
   treeselection = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->tree));
   if (gtk_tree_selection_get_selected (treeselection, &model, &iter))
     {
-      gchar *file_path = NULL;
-      gint line_number;
       gint position;
 
-      gtk_tree_model_get (GTK_TREE_MODEL (priv->store), &iter,
-                          FILE_PATH, &file_path,
-                          LINE_NUMBER, &line_number,
-                          POSITION, &position, -1);
-
-      codeslayer_select_document_by_file_path (priv->codeslayer, file_path, line_number);
-      
-      g_signal_emit_by_name ((gpointer) pane, "select-position", position);
-
-      g_free (file_path);
+      position = navigation_model_get_index (NAVIGATION_MODEL (model), &iter);
+      if (position >= 0)
+        g_signal_emit_by_name ((gpointer) pane, "select-position", position);
     }
 
   return FALSE;
@@ -21,6 +21,8 @@
 
 #include <gtk/gtk.h>
 #include <codeslayer/codeslayer.h>
+#include "navigation-history.h"
+#include "navigation-hotspots.h"
 
 G_BEGIN_DECLS
 
@@ -43,15 +45,19 @@ struct _NavigationPaneClass
   GtkVBoxClass parent_class;
 
   void (*select_position) (NavigationPane *pane);
+  void (*select_location) (NavigationPane *pane);
 };
 
 GType navigation_pane_get_type (void) G_GNUC_CONST;
      
-GtkWidget*  navigation_pane_new           (CodeSlayer     *codeslayer);
+GtkWidget*  navigation_pane_new              (CodeSlayer         *codeslayer,
+                                              NavigationHistory  *history,
+                                              NavigationHotspots *hotspots);
 
-void        navigation_pane_refresh_path  (NavigationPane *pane, 
-                                           GList          *path, 
-                                           gint            position);
+void        navigation_pane_refresh          (NavigationPane     *pane,
+                                              guint64             truncated_at);
+void        navigation_pane_set_history      (NavigationPane     *pane,
+                                              NavigationHistory  *history);
 
 G_END_DECLS
 
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include "navigation-path.h"
+
+struct _NavigationPath
+{
+  gchar              *file_path;
+  guint               ref_count;
+  NavigationPathPool *pool;
+  gchar              *display_name;
+  guint               display_generation;
+  gchar              *partition_key;
+  guint               partition_generation;
+  gboolean            missing;
+};
+
+struct _NavigationPathPool
+{
+  GHashTable         *paths;
+  NavigationPathFunc  added;
+  NavigationPathFunc  removed;
+  gpointer            listener_data;
+};
+
+static void
+path_free (NavigationPath *path)
+{
+  g_free (path->file_path);
+  g_free (path->display_name);
+  g_free (path->partition_key);
+  g_slice_free (NavigationPath, path);
+}
+
+static void
+path_detach (gpointer key,
+             gpointer value,
+             gpointer user_data)
+{
+  NavigationPath *path = value;
+  path->pool = NULL;
+}
+
+NavigationPathPool*
+navigation_path_pool_new (void)
+{
+  NavigationPathPool *pool;
+  pool = g_new0 (NavigationPathPool, 1);
+  pool->paths = g_hash_table_new (g_str_hash, g_str_equal);
+  return pool;
+}
+
+void
+navigation_path_pool_free (NavigationPathPool *pool)
+{
+  g_hash_table_foreach (pool->paths, path_detach, NULL);
+  g_hash_table_destroy (pool->paths);
+  g_free (pool);
+}
+
+NavigationPath*
+navigation_path_pool_intern (NavigationPathPool *pool,
+                             const gchar        *file_path)
+{
+  NavigationPath *path;
+
+  g_return_val_if_fail (file_path != NULL, NULL);
+
+  path = g_hash_table_lookup (pool->paths, file_path);
+  if (path != NULL)
+    return navigation_path_ref (path);
+
+  path = g_slice_new0 (NavigationPath);
+  path->file_path = g_strdup (file_path);
+  path->ref_count = 1;
+  path->pool = pool;
+
+  g_hash_table_insert (pool->paths, path->file_path, path);
+  
+  if (pool->added != NULL)
+    pool->added (path, pool->listener_data);
+
+  return path;
+}
+
+NavigationPath*
+navigation_path_pool_lookup (NavigationPathPool *pool,
+                             const gchar        *file_path)
+{
+  if (file_path == NULL)
+    return NULL;
+  return g_hash_table_lookup (pool->paths, file_path);
+}
+
+guint
+navigation_path_pool_get_size (NavigationPathPool *pool)
+{
+  return g_hash_table_size (pool->paths);
+}
+
+/*
+ * Lets one listener follow the paths in the pool: added is called once a
+ * path is interned and removed just before its last reference goes. The
+ * paths already in the pool are passed to added straight away.
+ */
+void
+navigation_path_pool_set_listener (NavigationPathPool *pool,
+                                   NavigationPathFunc  added,
+                                   NavigationPathFunc  removed,
+                                   gpointer            user_data)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  pool->added = added;
+  pool->removed = removed;
+  pool->listener_data = user_data;
+
+  if (added == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, pool->paths);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    added (value, user_data);
+}
+
+NavigationPath*
+navigation_path_ref (NavigationPath *path)
+{
+  path->ref_count++;
+  return path;
+}
+
+void
+navigation_path_unref (NavigationPath *path)
+{
+  if (--path->ref_count > 0)
+    return;
+
+  if (path->pool != NULL)
+    {
+      if (path->pool->removed != NULL)
+        path->pool->removed (path, path->pool->listener_data);
+      g_hash_table_remove (path->pool->paths, path->file_path);
+    }
+
+  path_free (path);
+}
+
+const gchar*
+navigation_path_get_file_path (NavigationPath *path)
+{
+  return path->file_path;
+}
+
+/*
+ * The display name is cached against a generation supplied by the caller, so
+ * the caller can invalidate every cached name at once by bumping its
+ * generation, for instance when projects are added, removed or renamed.
+ */
+const gchar*
+navigation_path_get_display_name (NavigationPath *path,
+                                  guint           generation)
+{
+  if (path->display_name == NULL || path->display_generation != generation)
+    return NULL;
+  return path->display_name;
+}
+
+void
+navigation_path_set_display_name (NavigationPath *path,
+                                  gchar          *display_name,
+                                  guint           generation)
+{
+  g_free (path->display_name);
+  path->display_name = display_name;
+  path->display_generation = generation;
+}
+
+/*
+ * The key of the history the file belongs to, cached the same way as the
+ * display name.
+ */
+const gchar*
+navigation_path_get_partition_key (NavigationPath *path,
+                                   guint           generation)
+{
+  if (path->partition_key == NULL || path->partition_generation != generation)
+    return NULL;
+  return path->partition_key;
+}
+
+void
+navigation_path_set_partition_key (NavigationPath *path,
+                                   gchar          *partition_key,
+                                   guint           generation)
+{
+  g_free (path->partition_key);
+  path->partition_key = partition_key;
+  path->partition_generation = generation;
+}
+
+/*
+ * Set when the file is known to be gone. Every entry in the file shares the
+ * path, so they are all marked at once.
+ */
+gboolean
+navigation_path_get_missing (NavigationPath *path)
+{
+  return path->missing;
+}
+
+void
+navigation_path_set_missing (NavigationPath *path,
+                             gboolean        missing)
+{
+  path->missing = missing;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_PATH_H__
+#define __NAVIGATION_PATH_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * File paths are interned in a pool so that every node pointing at the same
+ * file shares one refcounted NavigationPath. Two nodes are in the same file
+ * exactly when their NavigationPath pointers are equal.
+ */
+typedef struct _NavigationPath NavigationPath;
+typedef struct _NavigationPathPool NavigationPathPool;
+
+typedef void (*NavigationPathFunc) (NavigationPath *path,
+                                    gpointer        user_data);
+
+NavigationPathPool*  navigation_path_pool_new       (void);
+void                 navigation_path_pool_free      (NavigationPathPool *pool);
+
+NavigationPath*      navigation_path_pool_intern    (NavigationPathPool *pool,
+                                                     const gchar        *file_path);
+NavigationPath*      navigation_path_pool_lookup    (NavigationPathPool *pool,
+                                                     const gchar        *file_path);
+guint                navigation_path_pool_get_size  (NavigationPathPool *pool);
+void                 navigation_path_pool_set_listener  (NavigationPathPool *pool,
+                                                         NavigationPathFunc  added,
+                                                         NavigationPathFunc  removed,
+                                                         gpointer            user_data);
+
+NavigationPath*      navigation_path_ref            (NavigationPath     *path);
+void                 navigation_path_unref          (NavigationPath     *path);
+
+const gchar*         navigation_path_get_file_path  (NavigationPath     *path);
+
+const gchar*         navigation_path_get_display_name  (NavigationPath *path,
+                                                        guint           generation);
+void                 navigation_path_set_display_name  (NavigationPath *path,
+                                                        gchar          *display_name,
+                                                        guint           generation);
+
+const gchar*         navigation_path_get_partition_key  (NavigationPath *path,
+                                                         guint           generation);
+void                 navigation_path_set_partition_key  (NavigationPath *path,
+                                                         gchar          *partition_key,
+                                                         guint           generation);
+
+gboolean             navigation_path_get_missing    (NavigationPath     *path);
+void                 navigation_path_set_missing    (NavigationPath     *path,
+                                                     gboolean            missing);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_PATH_H__ */
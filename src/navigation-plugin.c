@@ -28,25 +28,48 @@ G_MODULE_EXPORT void activate    (CodeSlayer *codeslayer);
 G_MODULE_EXPORT void deactivate  (CodeSlayer *codeslayer);
 G_MODULE_EXPORT void configure   (CodeSlayer *codeslayer);
 
+G_MODULE_EXPORT NavigationEngine* navigation_get_engine (void);
+
 NavigationEngine *engine;
 GtkWidget *menu;
 
+/* held while the engine is handed out or taken away */
+G_LOCK_DEFINE_STATIC (engine);
+
 G_MODULE_EXPORT void
 activate (CodeSlayer *codeslayer)
 {
   GtkAccelGroup *accel_group;
+  gint64 started;
+  
+  started = g_get_monotonic_time ();
+  
   accel_group = codeslayer_get_menu_bar_accel_group (codeslayer);
   menu = navigation_menu_new (accel_group);
   codeslayer_add_to_menu_bar (codeslayer, GTK_MENU_ITEM (menu));  
 
-  engine = navigation_engine_new (codeslayer, menu);
+  G_LOCK (engine);
+  g_atomic_pointer_set (&engine, navigation_engine_new (codeslayer, menu));
+  G_UNLOCK (engine);
+  
+  g_debug ("navigation: activated in %.1f ms", 
+           (g_get_monotonic_time () - started) / 1000.0);
 }
 
 G_MODULE_EXPORT void 
 deactivate (CodeSlayer *codeslayer)
 {
+  NavigationEngine *old_engine;
+  
   codeslayer_remove_from_menu_bar (codeslayer, GTK_MENU_ITEM (menu));
-  g_object_unref (engine);
+  
+  G_LOCK (engine);
+  old_engine = g_atomic_pointer_get (&engine);
+  g_atomic_pointer_set (&engine, NULL);
+  G_UNLOCK (engine);
+  
+  /* whoever got the engine from navigation_get_engine keeps it alive */
+  g_object_unref (old_engine);
 }
 
 G_MODULE_EXPORT void 
@@ -54,3 +77,16 @@ configure  (CodeSlayer *codeslayer)
 {
   navigation_engine_open_dialog (engine);
 }
+
+G_MODULE_EXPORT NavigationEngine*
+navigation_get_engine (void)
+{
+  NavigationEngine *result = NULL;
+  
+  G_LOCK (engine);
+  if (g_atomic_pointer_get (&engine) != NULL)
+    result = g_object_ref (g_atomic_pointer_get (&engine));
+  G_UNLOCK (engine);
+  
+  return result;
+}
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include "navigation-prefetcher.h"
+
+/*
+ * Pulls the files next to the current position into the page cache from a
+ * worker thread, so that walking back or forward opens them warm. The files
+ * counted as warm are kept in most recently used order, and once they add up
+ * to more than the budget the oldest are forgotten, which leaves their pages
+ * for the kernel to reclaim like any other. Asking for other files cancels
+ * whatever is still being read for the last ones.
+ */
+
+static void navigation_prefetcher_class_init  (NavigationPrefetcherClass *klass);
+static void navigation_prefetcher_init        (NavigationPrefetcher      *prefetcher);
+static void navigation_prefetcher_finalize    (NavigationPrefetcher      *prefetcher);
+
+#define NAVIGATION_PREFETCHER_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_PREFETCHER_TYPE, NavigationPrefetcherPrivate))
+
+#define READ_SIZE 65536
+
+typedef struct _NavigationPrefetcherPrivate NavigationPrefetcherPrivate;
+
+struct _NavigationPrefetcherPrivate
+{
+  guint64       budget;
+  guint64       size;
+  GQueue       *warm;
+  GHashTable   *index;
+  gboolean      running;
+  GCancellable *cancellable;
+};
+
+typedef struct
+{
+  gchar  *file_path;
+  gint64  size;
+} Warm;
+
+typedef struct
+{
+  gchar   **file_paths;
+  gint64   *sizes;
+  guint64   budget;
+} Batch;
+
+G_DEFINE_TYPE (NavigationPrefetcher, navigation_prefetcher, G_TYPE_OBJECT)
+
+static void
+navigation_prefetcher_class_init (NavigationPrefetcherClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->finalize = (GObjectFinalizeFunc) navigation_prefetcher_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationPrefetcherPrivate));
+}
+
+static void
+warm_free (Warm *warm)
+{
+  g_free (warm->file_path);
+  g_slice_free (Warm, warm);
+}
+
+static void
+batch_free (Batch *batch)
+{
+  g_strfreev (batch->file_paths);
+  g_free (batch->sizes);
+  g_slice_free (Batch, batch);
+}
+
+static void
+navigation_prefetcher_init (NavigationPrefetcher *prefetcher)
+{
+  NavigationPrefetcherPrivate *priv;
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+  priv->budget = 0;
+  priv->size = 0;
+  priv->warm = g_queue_new ();
+  priv->index = g_hash_table_new (g_str_hash, g_str_equal);
+  priv->running = FALSE;
+  priv->cancellable = g_cancellable_new ();
+}
+
+static void
+navigation_prefetcher_finalize (NavigationPrefetcher *prefetcher)
+{
+  NavigationPrefetcherPrivate *priv;
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+  
+  /* a batch still being read sees this and leaves the prefetcher alone */
+  g_cancellable_cancel (priv->cancellable);
+  g_object_unref (priv->cancellable);
+  
+  g_hash_table_destroy (priv->index);
+  g_queue_free_full (priv->warm, (GDestroyNotify) warm_free);
+  
+  G_OBJECT_CLASS (navigation_prefetcher_parent_class)->finalize (G_OBJECT (prefetcher));
+}
+
+/*
+ * budget is in bytes, and a file bigger than it is never read.
+ */
+NavigationPrefetcher*
+navigation_prefetcher_new (guint64 budget)
+{
+  NavigationPrefetcherPrivate *priv;
+  NavigationPrefetcher *prefetcher;
+
+  prefetcher = NAVIGATION_PREFETCHER (g_object_new (navigation_prefetcher_get_type (), NULL));
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+  priv->budget = budget;
+
+  return prefetcher;
+}
+
+/*
+ * The size of the file once it is on its way into the page cache, or -1 if
+ * it was left alone.
+ */
+static gint64
+warm_file (const gchar  *file_path,
+           guint64       budget,
+           GCancellable *cancellable)
+{
+  struct stat st;
+  gint64 size;
+  int fd;
+
+  fd = g_open (file_path, O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+
+  if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode) || (guint64) st.st_size > budget)
+    {
+      close (fd);
+      return -1;
+    }
+
+  size = st.st_size;
+
+#ifdef POSIX_FADV_WILLNEED
+  posix_fadvise (fd, 0, size, POSIX_FADV_WILLNEED);
+#else
+  {
+    gchar buffer[READ_SIZE];
+    while (!g_cancellable_is_cancelled (cancellable) && read (fd, buffer, sizeof (buffer)) > 0)
+      ;
+  }
+#endif
+
+  close (fd);
+
+  return size;
+}
+
+static void
+prefetch_thread (GTask        *task,
+                 gpointer      source_object,
+                 Batch        *batch,
+                 GCancellable *cancellable)
+{
+  guint64 spent = 0;
+  guint i;
+
+  /* the batch as a whole stays within the budget */
+  for (i = 0; batch->file_paths[i] != NULL; i++)
+    {
+      if (g_task_return_error_if_cancelled (task))
+        return;
+      batch->sizes[i] = warm_file (batch->file_paths[i], batch->budget - spent, cancellable);
+      if (batch->sizes[i] > 0)
+        spent += batch->sizes[i];
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+remember (NavigationPrefetcher *prefetcher,
+          const gchar          *file_path,
+          gint64                size)
+{
+  NavigationPrefetcherPrivate *priv;
+  Warm *warm;
+
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+
+  warm = g_slice_new (Warm);
+  warm->file_path = g_strdup (file_path);
+  warm->size = size;
+
+  g_queue_push_head (priv->warm, warm);
+  g_hash_table_insert (priv->index, warm->file_path, priv->warm->head);
+  priv->size += size;
+
+  /* the newest file fits on its own, so it is never the one to go */
+  while (priv->size > priv->budget)
+    {
+      warm = g_queue_pop_tail (priv->warm);
+      g_hash_table_remove (priv->index, warm->file_path);
+      priv->size -= warm->size;
+      warm_free (warm);
+    }
+}
+
+static void
+prefetch_done (GObject              *source_object,
+               GAsyncResult         *result,
+               NavigationPrefetcher *prefetcher)
+{
+  NavigationPrefetcherPrivate *priv;
+  Batch *batch;
+  guint i;
+
+  /* the prefetcher is already gone, or has moved on to other files */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+  priv->running = FALSE;
+
+  if (!g_task_propagate_boolean (G_TASK (result), NULL))
+    return;
+
+  batch = g_task_get_task_data (G_TASK (result));
+
+  for (i = 0; batch->file_paths[i] != NULL; i++)
+    {
+      if (batch->sizes[i] >= 0 && g_hash_table_lookup (priv->index, batch->file_paths[i]) == NULL)
+        remember (prefetcher, batch->file_paths[i], batch->sizes[i]);
+    }
+}
+
+/*
+ * Starts reading file_paths, a NULL terminated array, in place of anything
+ * asked for before. Files still counted as warm are only moved to the front.
+ */
+void
+navigation_prefetcher_warm (NavigationPrefetcher  *prefetcher,
+                            const gchar          **file_paths)
+{
+  NavigationPrefetcherPrivate *priv;
+  GPtrArray *cold;
+  guint64 kept = 0;
+  Batch *batch;
+  GTask *task;
+  guint i;
+
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+
+  navigation_prefetcher_cancel (prefetcher);
+
+  cold = g_ptr_array_new ();
+
+  for (; *file_paths != NULL; file_paths++)
+    {
+      GList *link;
+
+      link = g_hash_table_lookup (priv->index, *file_paths);
+      if (link != NULL)
+        {
+          g_queue_unlink (priv->warm, link);
+          g_queue_push_head_link (priv->warm, link);
+          kept += ((Warm *) link->data)->size;
+          continue;
+        }
+
+      for (i = 0; i < cold->len; i++)
+        {
+          if (g_strcmp0 (g_ptr_array_index (cold, i), *file_paths) == 0)
+            break;
+        }
+
+      if (i == cold->len)
+        g_ptr_array_add (cold, g_strdup (*file_paths));
+    }
+
+  /* the files asked for that are still warm leave that much less to read */
+  if (cold->len == 0 || kept >= priv->budget)
+    {
+      g_ptr_array_free (cold, TRUE);
+      return;
+    }
+
+  batch = g_slice_new (Batch);
+  batch->sizes = g_new (gint64, cold->len);
+  batch->budget = priv->budget - kept;
+  g_ptr_array_add (cold, NULL);
+  batch->file_paths = (gchar **) g_ptr_array_free (cold, FALSE);
+
+  priv->running = TRUE;
+
+  task = g_task_new (NULL, priv->cancellable, 
+                     (GAsyncReadyCallback) prefetch_done, prefetcher);
+  g_task_set_task_data (task, batch, (GDestroyNotify) batch_free);
+  g_task_run_in_thread (task, (GTaskThreadFunc) prefetch_thread);
+  g_object_unref (task);
+}
+
+/*
+ * Stops reading the files last asked for.
+ */
+void
+navigation_prefetcher_cancel (NavigationPrefetcher *prefetcher)
+{
+  NavigationPrefetcherPrivate *priv;
+  priv = NAVIGATION_PREFETCHER_GET_PRIVATE (prefetcher);
+
+  if (!priv->running)
+    return;
+
+  g_cancellable_cancel (priv->cancellable);
+  g_object_unref (priv->cancellable);
+  priv->cancellable = g_cancellable_new ();
+  priv->running = FALSE;
+}
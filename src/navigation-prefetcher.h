@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_PREFETCHER_H__
+#define __NAVIGATION_PREFETCHER_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_PREFETCHER_TYPE            (navigation_prefetcher_get_type ())
+#define NAVIGATION_PREFETCHER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_PREFETCHER_TYPE, NavigationPrefetcher))
+#define NAVIGATION_PREFETCHER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_PREFETCHER_TYPE, NavigationPrefetcherClass))
+#define IS_NAVIGATION_PREFETCHER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_PREFETCHER_TYPE))
+#define IS_NAVIGATION_PREFETCHER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_PREFETCHER_TYPE))
+
+typedef struct _NavigationPrefetcher NavigationPrefetcher;
+typedef struct _NavigationPrefetcherClass NavigationPrefetcherClass;
+
+struct _NavigationPrefetcher
+{
+  GObject parent_instance;
+};
+
+struct _NavigationPrefetcherClass
+{
+  GObjectClass parent_class;
+};
+
+GType navigation_prefetcher_get_type (void) G_GNUC_CONST;
+
+NavigationPrefetcher*  navigation_prefetcher_new     (guint64                budget);
+
+void                   navigation_prefetcher_warm    (NavigationPrefetcher  *prefetcher,
+                                                      const gchar          **file_paths);
+void                   navigation_prefetcher_cancel  (NavigationPrefetcher  *prefetcher);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_PREFETCHER_H__ */
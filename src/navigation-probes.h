@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_PROBES_H__
+#define __NAVIGATION_PROBES_H__
+
+#include <glib.h>
+#include "navigation-node.h"
+
+/*
+ * Static tracepoints, compiled in with ./configure --enable-usdt. Each fires
+ * with a file path and a line number, for example:
+ *
+ *   bpftrace -e 'usdt:libnavigationcodeslayerplugin.so:navigation:history__push 
+ *                { printf ("%s:%d\n", str (arg0), arg1); }'
+ *
+ * Every probe has a semaphore that perf and bpftrace raise while they are
+ * attached, and the arguments are only worked out when it is up, so a
+ * probe that is not armed costs a load and a branch. Without --enable-usdt
+ * it is not there at all.
+ */
+
+#ifdef HAVE_USDT
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+/* weak, so every file that includes this shares the one semaphore */
+#define NAVIGATION_PROBE_SEMAPHORE(name) \
+  __extension__ unsigned short navigation_##name##_semaphore \
+    __attribute__ ((unused, weak, section (".probes"), visibility ("hidden")))
+
+NAVIGATION_PROBE_SEMAPHORE (history__push);
+NAVIGATION_PROBE_SEMAPHORE (history__truncate);
+NAVIGATION_PROBE_SEMAPHORE (history__evict);
+NAVIGATION_PROBE_SEMAPHORE (position__change);
+NAVIGATION_PROBE_SEMAPHORE (pane__refresh__begin);
+NAVIGATION_PROBE_SEMAPHORE (pane__refresh__end);
+NAVIGATION_PROBE_SEMAPHORE (document__select__begin);
+NAVIGATION_PROBE_SEMAPHORE (document__select__end);
+
+#define NAVIGATION_PROBE_ENABLED(name) \
+  G_UNLIKELY (navigation_##name##_semaphore != 0)
+
+#define NAVIGATION_PROBE(name, file_path, line_number) G_STMT_START { \
+    if (NAVIGATION_PROBE_ENABLED (name)) \
+      DTRACE_PROBE2 (navigation, name, file_path, line_number); \
+  } G_STMT_END
+
+/* a NULL node, such as the current one of an empty history, fires as NULL:0 */
+#define NAVIGATION_PROBE_NODE(name, node) G_STMT_START { \
+    if (NAVIGATION_PROBE_ENABLED (name)) \
+      { \
+        NavigationNode *probe_node = (node); \
+        DTRACE_PROBE2 (navigation, name, \
+                       probe_node != NULL ? navigation_node_get_file_path (probe_node) : NULL, \
+                       probe_node != NULL ? navigation_node_get_line_number (probe_node) : 0); \
+      } \
+  } G_STMT_END
+
+#else
+
+#define NAVIGATION_PROBE_ENABLED(name) FALSE
+#define NAVIGATION_PROBE(name, file_path, line_number) G_STMT_START { } G_STMT_END
+#define NAVIGATION_PROBE_NODE(name, node) G_STMT_START { } G_STMT_END
+
+#endif
+
+#endif /* __NAVIGATION_PROBES_H__ */
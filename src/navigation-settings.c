@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include "navigation-settings.h"
+
+/*
+ * navigation.conf, read once from a worker thread and kept in memory. Until
+ * it has been read the defaults stand in. The values are parsed into plain
+ * fields so reading a setting never touches the key file, let alone the
+ * disk. Changes are written back a moment later from a worker thread,
+ * and edits made to the file by hand are picked up through a file monitor
+ * and announced with the detailed "changed" signal. Every key takes effect
+ * that way except persist_history, which is only read at startup.
+ */
+
+static void navigation_settings_class_init  (NavigationSettingsClass *klass);
+static void navigation_settings_init        (NavigationSettings      *settings);
+static void navigation_settings_finalize    (NavigationSettings      *settings);
+
+static void file_changed                    (GFileMonitor            *monitor,
+                                             GFile                   *file,
+                                             GFile                   *other_file,
+                                             GFileMonitorEvent        event,
+                                             NavigationSettings      *settings);
+static void schedule_flush                  (NavigationSettings      *settings);
+
+#define NAVIGATION_SETTINGS_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_SETTINGS_TYPE, NavigationSettingsPrivate))
+
+#define MAIN "main"
+#define DEFAULT_HISTORY_CAPACITY 25
+#define MIN_HISTORY_CAPACITY 2
+#define DEFAULT_SELECT_DELAY 100
+#define DEFAULT_PREFETCH_BUDGET 16384
+#define FLUSH_DELAY 1
+
+typedef struct
+{
+  gboolean show_side_pane;
+  guint    history_capacity;
+  guint    select_delay;
+  gboolean persist_history;
+  gboolean validate_files;
+  guint    prefetch_budget;
+  gboolean partition_by_project;
+} Values;
+
+typedef struct _NavigationSettingsPrivate NavigationSettingsPrivate;
+
+struct _NavigationSettingsPrivate
+{
+  GFile        *file;
+  GKeyFile     *key_file;
+  Values        values;
+  GFileMonitor *monitor;
+  guint         flush_id;
+  gboolean      loaded;
+  gboolean      dirty;
+  gboolean      writing;
+  GCancellable *cancellable;
+};
+
+typedef struct
+{
+  NavigationSettings *settings;
+  gchar              *data;
+} Write;
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint navigation_settings_signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (NavigationSettings, navigation_settings, G_TYPE_OBJECT)
+
+static void
+navigation_settings_class_init (NavigationSettingsClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  navigation_settings_signals[CHANGED] =
+    g_signal_new ("changed", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationSettingsClass, changed), 
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+  gobject_class->finalize = (GObjectFinalizeFunc) navigation_settings_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationSettingsPrivate));
+}
+
+static void
+navigation_settings_init (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  priv->file = NULL;
+  priv->key_file = g_key_file_new ();
+  priv->monitor = NULL;
+  priv->flush_id = 0;
+  priv->loaded = FALSE;
+  priv->dirty = FALSE;
+  priv->writing = FALSE;
+  priv->cancellable = g_cancellable_new ();
+}
+
+static void
+navigation_settings_finalize (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  navigation_settings_flush (settings);
+  
+  if (priv->monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->monitor, file_changed, settings);
+      g_file_monitor_cancel (priv->monitor);
+      g_object_unref (priv->monitor);
+    }
+  
+  g_object_unref (priv->cancellable);
+  g_key_file_free (priv->key_file);
+  g_object_unref (priv->file);
+  
+  G_OBJECT_CLASS (navigation_settings_parent_class)->finalize (G_OBJECT (settings));
+}
+
+static gboolean
+get_boolean (GKeyFile    *key_file,
+             const gchar *key,
+             gboolean     default_value)
+{
+  GError *error = NULL;
+  gboolean result;
+  
+  result = g_key_file_get_boolean (key_file, MAIN, key, &error);
+  if (error != NULL)
+    {
+      g_error_free (error);
+      return default_value;
+    }
+  
+  return result;
+}
+
+static gint
+get_integer (GKeyFile    *key_file,
+             const gchar *key,
+             gint         default_value)
+{
+  GError *error = NULL;
+  gint result;
+  
+  result = g_key_file_get_integer (key_file, MAIN, key, &error);
+  if (error != NULL)
+    {
+      g_error_free (error);
+      return default_value;
+    }
+  
+  return result;
+}
+
+static void
+parse_values (GKeyFile *key_file, 
+              Values   *values)
+{
+  values->show_side_pane = get_boolean (key_file, NAVIGATION_SETTINGS_SHOW_SIDE_PANE, FALSE);
+  values->history_capacity = MAX (MIN_HISTORY_CAPACITY, 
+                                  get_integer (key_file, NAVIGATION_SETTINGS_HISTORY_CAPACITY, 
+                                               DEFAULT_HISTORY_CAPACITY));
+  values->select_delay = MAX (0, get_integer (key_file, NAVIGATION_SETTINGS_SELECT_DELAY, 
+                                              DEFAULT_SELECT_DELAY));
+  values->persist_history = get_boolean (key_file, NAVIGATION_SETTINGS_PERSIST_HISTORY, TRUE);
+  values->validate_files = get_boolean (key_file, NAVIGATION_SETTINGS_VALIDATE_FILES, TRUE);
+  values->prefetch_budget = MAX (0, get_integer (key_file, NAVIGATION_SETTINGS_PREFETCH_BUDGET, 
+                                                 DEFAULT_PREFETCH_BUDGET));
+  values->partition_by_project = get_boolean (key_file, NAVIGATION_SETTINGS_PARTITION_BY_PROJECT, FALSE);
+}
+
+static void
+emit_changed (NavigationSettings *settings,
+              const gchar        *key)
+{
+  g_signal_emit (settings, navigation_settings_signals[CHANGED], 
+                 g_quark_from_static_string (key));
+}
+
+/*
+ * Rereads the file and announces every value that differs from before.
+ */
+static void
+load (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  Values old_values;
+  gchar *file_path;
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  g_key_file_free (priv->key_file);
+  priv->key_file = g_key_file_new ();
+  
+  file_path = g_file_get_path (priv->file);
+  g_key_file_load_from_file (priv->key_file, file_path, G_KEY_FILE_KEEP_COMMENTS, NULL);
+  g_free (file_path);
+  
+  old_values = priv->values;
+  parse_values (priv->key_file, &priv->values);
+  
+  if (old_values.show_side_pane != priv->values.show_side_pane)
+    emit_changed (settings, NAVIGATION_SETTINGS_SHOW_SIDE_PANE);
+  if (old_values.history_capacity != priv->values.history_capacity)
+    emit_changed (settings, NAVIGATION_SETTINGS_HISTORY_CAPACITY);
+  if (old_values.select_delay != priv->values.select_delay)
+    emit_changed (settings, NAVIGATION_SETTINGS_SELECT_DELAY);
+  if (old_values.persist_history != priv->values.persist_history)
+    emit_changed (settings, NAVIGATION_SETTINGS_PERSIST_HISTORY);
+  if (old_values.validate_files != priv->values.validate_files)
+    emit_changed (settings, NAVIGATION_SETTINGS_VALIDATE_FILES);
+  if (old_values.prefetch_budget != priv->values.prefetch_budget)
+    emit_changed (settings, NAVIGATION_SETTINGS_PREFETCH_BUDGET);
+  if (old_values.partition_by_project != priv->values.partition_by_project)
+    emit_changed (settings, NAVIGATION_SETTINGS_PARTITION_BY_PROJECT);
+}
+
+NavigationSettings*
+navigation_settings_new (const gchar *file_path)
+{
+  NavigationSettingsPrivate *priv;
+  NavigationSettings *settings;
+  GError *error = NULL;
+
+  settings = NAVIGATION_SETTINGS (g_object_new (navigation_settings_get_type (), NULL));
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  priv->file = g_file_new_for_path (file_path);
+  parse_values (priv->key_file, &priv->values);
+  
+  priv->monitor = g_file_monitor_file (priv->file, G_FILE_MONITOR_NONE, NULL, &error);
+  if (priv->monitor != NULL)
+    {
+      g_signal_connect (G_OBJECT (priv->monitor), "changed", 
+                        G_CALLBACK (file_changed), settings);
+    }
+  else
+    {
+      g_debug ("navigation: unable to monitor %s: %s", file_path, error->message);
+      g_error_free (error);
+    }
+
+  return settings;
+}
+
+static void
+load_thread (GTask        *task,
+             gpointer      source_object,
+             GFile        *file,
+             GCancellable *cancellable)
+{
+  GKeyFile *key_file;
+  GError *error = NULL;
+  gchar *contents;
+  gsize length;
+  
+  key_file = g_key_file_new ();
+  
+  if (g_file_load_contents (file, cancellable, &contents, &length, NULL, &error))
+    {
+      g_key_file_load_from_data (key_file, contents, length, G_KEY_FILE_KEEP_COMMENTS, NULL);
+      g_free (contents);
+    }
+  else if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+    {
+      g_error_free (error);
+    }
+  else
+    {
+      g_key_file_free (key_file);
+      g_task_return_error (task, error);
+      return;
+    }
+  
+  g_task_return_pointer (task, key_file, (GDestroyNotify) g_key_file_free);
+}
+
+/*
+ * Reads the file from a worker thread so that activating the plugin does not
+ * wait on the disk. A file that does not exist yet leaves the defaults.
+ */
+void
+navigation_settings_load_async (NavigationSettings  *settings,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  NavigationSettingsPrivate *priv;
+  GTask *task;
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  task = g_task_new (settings, cancellable, callback, user_data);
+  g_task_set_task_data (task, g_object_ref (priv->file), g_object_unref);
+  g_task_run_in_thread (task, (GTaskThreadFunc) load_thread);
+  g_object_unref (task);
+}
+
+/*
+ * Takes the values read by navigation_settings_load_async. A setting changed
+ * in the meantime wins over the file, which it is then written back to.
+ */
+gboolean
+navigation_settings_load_finish (NavigationSettings  *settings,
+                                 GAsyncResult        *result,
+                                 GError             **error)
+{
+  NavigationSettingsPrivate *priv;
+  GKeyFile *key_file;
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  priv->loaded = TRUE;
+  
+  key_file = g_task_propagate_pointer (G_TASK (result), error);
+  if (key_file == NULL)
+    return FALSE;
+  
+  g_key_file_free (priv->key_file);
+  priv->key_file = key_file;
+  
+  if (priv->dirty)
+    {
+      g_key_file_set_boolean (priv->key_file, MAIN, NAVIGATION_SETTINGS_SHOW_SIDE_PANE, 
+                              priv->values.show_side_pane);
+      priv->dirty = FALSE;
+      schedule_flush (settings);
+    }
+  
+  parse_values (priv->key_file, &priv->values);
+  
+  return TRUE;
+}
+
+/*
+ * Our own writes come back through the monitor as well. While one is still
+ * pending or running the file is older than what is in memory, so it is
+ * left alone until the write has landed.
+ */
+static void
+file_changed (GFileMonitor       *monitor,
+              GFile              *file,
+              GFile              *other_file,
+              GFileMonitorEvent   event,
+              NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  if (event != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT && 
+      event != G_FILE_MONITOR_EVENT_CREATED && 
+      event != G_FILE_MONITOR_EVENT_DELETED)
+    return;
+  
+  if (!priv->loaded || priv->dirty || priv->writing)
+    return;
+  
+  load (settings);
+}
+
+static void
+write_done (GFile        *file,
+            GAsyncResult *result,
+            Write        *write)
+{
+  NavigationSettingsPrivate *priv;
+  GError *error = NULL;
+  
+  if (!g_file_replace_contents_finish (file, result, NULL, &error))
+    {
+      /* navigation_settings_flush wrote the file out in its place */
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_error_free (error);
+          g_free (write->data);
+          g_slice_free (Write, write);
+          return;
+        }
+      
+      g_warning ("navigation: unable to write settings: %s", error->message);
+      g_error_free (error);
+    }
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (write->settings);
+  priv->writing = FALSE;
+  
+  if (priv->dirty)
+    schedule_flush (write->settings);
+  
+  g_free (write->data);
+  g_slice_free (Write, write);
+}
+
+static gboolean
+flush_timeout (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  Write *write;
+  gsize length;
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  priv->flush_id = 0;
+  priv->dirty = FALSE;
+  priv->writing = TRUE;
+  
+  write = g_slice_new (Write);
+  write->settings = settings;
+  write->data = g_key_file_to_data (priv->key_file, &length, NULL);
+  
+  g_file_replace_contents_async (priv->file, write->data, length, NULL, FALSE, 
+                                 G_FILE_CREATE_NONE, priv->cancellable, 
+                                 (GAsyncReadyCallback) write_done, write);
+  
+  return FALSE;
+}
+
+static void
+schedule_flush (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  priv->dirty = TRUE;
+  
+  /* nothing to write over the file with until it has been read */
+  if (!priv->loaded || priv->writing || priv->flush_id != 0)
+    return;
+  
+  priv->flush_id = g_timeout_add_seconds (FLUSH_DELAY, (GSourceFunc) flush_timeout, settings);
+}
+
+/*
+ * Writes out any change still waiting, synchronously, in place of a write
+ * that may be running in the background.
+ */
+void
+navigation_settings_flush (NavigationSettings *settings)
+{
+  NavigationSettingsPrivate *priv;
+  GError *error = NULL;
+  gchar *file_path;
+  gchar *data;
+  gsize length;
+  
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  if (priv->flush_id != 0)
+    {
+      g_source_remove (priv->flush_id);
+      priv->flush_id = 0;
+    }
+  
+  if (!priv->loaded || (!priv->dirty && !priv->writing))
+    return;
+  
+  g_cancellable_cancel (priv->cancellable);
+  g_object_unref (priv->cancellable);
+  priv->cancellable = g_cancellable_new ();
+  
+  priv->dirty = FALSE;
+  priv->writing = FALSE;
+  
+  file_path = g_file_get_path (priv->file);
+  data = g_key_file_to_data (priv->key_file, &length, NULL);
+  
+  if (!g_file_set_contents (file_path, data, length, &error))
+    {
+      g_warning ("navigation: unable to write %s: %s", file_path, error->message);
+      g_error_free (error);
+    }
+  
+  g_free (file_path);
+  g_free (data);
+}
+
+gboolean
+navigation_settings_get_show_side_pane (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.show_side_pane;
+}
+
+void
+navigation_settings_set_show_side_pane (NavigationSettings *settings,
+                                        gboolean            show_side_pane)
+{
+  NavigationSettingsPrivate *priv;
+  priv = NAVIGATION_SETTINGS_GET_PRIVATE (settings);
+  
+  if (priv->values.show_side_pane == show_side_pane)
+    return;
+  
+  priv->values.show_side_pane = show_side_pane;
+  g_key_file_set_boolean (priv->key_file, MAIN, NAVIGATION_SETTINGS_SHOW_SIDE_PANE, 
+                          show_side_pane);
+  
+  schedule_flush (settings);
+  emit_changed (settings, NAVIGATION_SETTINGS_SHOW_SIDE_PANE);
+}
+
+guint
+navigation_settings_get_history_capacity (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.history_capacity;
+}
+
+guint
+navigation_settings_get_select_delay (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.select_delay;
+}
+
+gboolean
+navigation_settings_get_persist_history (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.persist_history;
+}
+
+gboolean
+navigation_settings_get_validate_files (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.validate_files;
+}
+
+/*
+ * In kilobytes, 0 turns prefetching off.
+ */
+guint
+navigation_settings_get_prefetch_budget (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.prefetch_budget;
+}
+
+/*
+ * Whether each project keeps a history of its own.
+ */
+gboolean
+navigation_settings_get_partition_by_project (NavigationSettings *settings)
+{
+  return NAVIGATION_SETTINGS_GET_PRIVATE (settings)->values.partition_by_project;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_SETTINGS_H__
+#define __NAVIGATION_SETTINGS_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_SETTINGS_TYPE            (navigation_settings_get_type ())
+#define NAVIGATION_SETTINGS(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_SETTINGS_TYPE, NavigationSettings))
+#define NAVIGATION_SETTINGS_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_SETTINGS_TYPE, NavigationSettingsClass))
+#define IS_NAVIGATION_SETTINGS(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_SETTINGS_TYPE))
+#define IS_NAVIGATION_SETTINGS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_SETTINGS_TYPE))
+
+#define NAVIGATION_SETTINGS_SHOW_SIDE_PANE "show_side_pane"
+#define NAVIGATION_SETTINGS_HISTORY_CAPACITY "history_capacity"
+#define NAVIGATION_SETTINGS_SELECT_DELAY "select_delay"
+#define NAVIGATION_SETTINGS_PERSIST_HISTORY "persist_history"
+#define NAVIGATION_SETTINGS_VALIDATE_FILES "validate_files"
+#define NAVIGATION_SETTINGS_PREFETCH_BUDGET "prefetch_budget"
+#define NAVIGATION_SETTINGS_PARTITION_BY_PROJECT "partition_by_project"
+
+typedef struct _NavigationSettings NavigationSettings;
+typedef struct _NavigationSettingsClass NavigationSettingsClass;
+
+struct _NavigationSettings
+{
+  GObject parent_instance;
+};
+
+struct _NavigationSettingsClass
+{
+  GObjectClass parent_class;
+
+  void (*changed) (NavigationSettings *settings);
+};
+
+GType navigation_settings_get_type (void) G_GNUC_CONST;
+
+NavigationSettings*  navigation_settings_new                   (const gchar         *file_path);
+
+void                 navigation_settings_load_async            (NavigationSettings  *settings,
+                                                                GCancellable        *cancellable,
+                                                                GAsyncReadyCallback  callback,
+                                                                gpointer             user_data);
+gboolean             navigation_settings_load_finish           (NavigationSettings  *settings,
+                                                                GAsyncResult        *result,
+                                                                GError             **error);
+
+gboolean             navigation_settings_get_show_side_pane    (NavigationSettings  *settings);
+void                 navigation_settings_set_show_side_pane    (NavigationSettings  *settings,
+                                                                gboolean             show_side_pane);
+guint                navigation_settings_get_history_capacity  (NavigationSettings  *settings);
+guint                navigation_settings_get_select_delay      (NavigationSettings  *settings);
+gboolean             navigation_settings_get_persist_history   (NavigationSettings  *settings);
+gboolean             navigation_settings_get_validate_files    (NavigationSettings  *settings);
+guint                navigation_settings_get_prefetch_budget   (NavigationSettings  *settings);
+gboolean             navigation_settings_get_partition_by_project  (NavigationSettings  *settings);
+
+void                 navigation_settings_flush                 (NavigationSettings  *settings);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_SETTINGS_H__ */
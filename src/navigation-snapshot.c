@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#include <gmodule.h>
+#include "navigation-snapshot.h"
+
+typedef struct
+{
+  NavigationPath *path;
+  gint            line_number;
+  gint64          timestamp;
+} Entry;
+
+struct _NavigationSnapshot
+{
+  volatile gint  ref_count;
+  guint64        epoch;
+  gint           position;
+  guint          length;
+  Entry         *entries;
+};
+
+/*
+ * Made on the main thread. The entries hold references on the interned
+ * paths rather than copies of the strings. A NULL history, as while it is
+ * still loading, gives an empty snapshot.
+ */
+NavigationSnapshot*
+navigation_snapshot_new (NavigationHistory *history,
+                         guint64            epoch)
+{
+  NavigationSnapshot *snapshot;
+  guint i;
+
+  snapshot = g_slice_new (NavigationSnapshot);
+  snapshot->ref_count = 1;
+  snapshot->epoch = epoch;
+  snapshot->position = history != NULL ? navigation_history_get_position (history) : 0;
+  snapshot->length = history != NULL ? navigation_history_get_length (history) : 0;
+  snapshot->entries = g_new (Entry, snapshot->length);
+
+  for (i = 0; i < snapshot->length; i++)
+    {
+      NavigationNode *node = navigation_history_get (history, i);
+      snapshot->entries[i].path = navigation_path_ref (navigation_node_get_path (node));
+      snapshot->entries[i].line_number = navigation_node_get_line_number (node);
+      snapshot->entries[i].timestamp = navigation_node_get_timestamp (node);
+    }
+
+  return snapshot;
+}
+
+G_MODULE_EXPORT NavigationSnapshot*
+navigation_snapshot_ref (NavigationSnapshot *snapshot)
+{
+  g_atomic_int_inc (&snapshot->ref_count);
+  return snapshot;
+}
+
+static gboolean
+snapshot_free (NavigationSnapshot *snapshot)
+{
+  guint i;
+
+  for (i = 0; i < snapshot->length; i++)
+    navigation_path_unref (snapshot->entries[i].path);
+
+  g_free (snapshot->entries);
+  g_slice_free (NavigationSnapshot, snapshot);
+
+  return FALSE;
+}
+
+/*
+ * Path references are not atomic, so the last reference is always freed
+ * from an idle on the main loop, wherever it was let go of.
+ */
+G_MODULE_EXPORT void
+navigation_snapshot_unref (NavigationSnapshot *snapshot)
+{
+  if (g_atomic_int_dec_and_test (&snapshot->ref_count))
+    g_idle_add ((GSourceFunc) snapshot_free, snapshot);
+}
+
+/*
+ * Whether every anchored node of history is still on the line the snapshot
+ * took. Anything else that changes the history moves the engine to a new
+ * epoch on its own.
+ */
+gboolean
+navigation_snapshot_is_current (NavigationSnapshot *snapshot,
+                                NavigationHistory  *history)
+{
+  guint i;
+
+  if (history == NULL)
+    return TRUE;
+
+  for (i = 0; i < snapshot->length && i < navigation_history_get_length (history); i++)
+    {
+      NavigationNode *node = navigation_history_get (history, i);
+      if (navigation_node_is_anchored (node) && 
+          navigation_node_get_line_number (node) != snapshot->entries[i].line_number)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* bumped by the engine each time the history changes */
+G_MODULE_EXPORT guint64
+navigation_snapshot_get_epoch (NavigationSnapshot *snapshot)
+{
+  return snapshot->epoch;
+}
+
+G_MODULE_EXPORT guint
+navigation_snapshot_get_length (NavigationSnapshot *snapshot)
+{
+  return snapshot->length;
+}
+
+G_MODULE_EXPORT gint
+navigation_snapshot_get_position (NavigationSnapshot *snapshot)
+{
+  return snapshot->position;
+}
+
+/*
+ * Calls func on each entry from the oldest on, until it returns FALSE.
+ */
+G_MODULE_EXPORT void
+navigation_snapshot_foreach (NavigationSnapshot     *snapshot,
+                             NavigationSnapshotFunc  func,
+                             gpointer                user_data)
+{
+  guint i;
+
+  for (i = 0; i < snapshot->length; i++)
+    {
+      Entry *entry = &snapshot->entries[i];
+      if (!func (navigation_path_get_file_path (entry->path), 
+                 entry->line_number, entry->timestamp, user_data))
+        break;
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+#ifndef __NAVIGATION_SNAPSHOT_H__
+#define __NAVIGATION_SNAPSHOT_H__
+
+#include <glib.h>
+#include "navigation.h"
+#include "navigation-history.h"
+
+G_BEGIN_DECLS
+
+NavigationSnapshot*  navigation_snapshot_new         (NavigationHistory  *history,
+                                                      guint64             epoch);
+gboolean             navigation_snapshot_is_current  (NavigationSnapshot *snapshot,
+                                                      NavigationHistory  *history);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_SNAPSHOT_H__ */
@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include "navigation-snippets.h"
+
+/*
+ * The text of a line in a file, for showing next to a history entry. Each
+ * file is scanned for line starts once, on a worker thread, after which any
+ * line is a single pread on the descriptor kept open for it. Reading rather
+ * than mapping means a file truncated underneath only gives a short read.
+ * The file's mtime and size are looked at again at most once a second, and
+ * an index that no longer matches is rebuilt. Until an index is ready there
+ * is no snippet, and "changed" is emitted once it is.
+ *
+ * The indexes of the files asked for during the current draw are never
+ * evicted, so the cache grows to whatever the pane has on screen.
+ */
+
+static void navigation_snippets_class_init  (NavigationSnippetsClass *klass);
+static void navigation_snippets_init        (NavigationSnippets      *snippets);
+static void navigation_snippets_finalize    (NavigationSnippets      *snippets);
+
+#define NAVIGATION_SNIPPETS_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_SNIPPETS_TYPE, NavigationSnippetsPrivate))
+
+#define MAX_INDEXES 32
+#define MAX_FILE_SIZE (16 * 1024 * 1024)
+#define MAX_SNIPPET_LENGTH 120
+#define READ_SIZE 65536
+#define LINE_READ_SIZE 1024
+#define CHECK_INTERVAL G_USEC_PER_SEC
+
+typedef struct _NavigationSnippetsPrivate NavigationSnippetsPrivate;
+
+struct _NavigationSnippetsPrivate
+{
+  GHashTable   *indexes;
+  GQueue       *recent;
+  guint         draw;
+  guint         next_generation;
+  GString      *snippet;
+  GCancellable *cancellable;
+};
+
+typedef struct
+{
+  gchar       *file_path;
+  guint        generation;
+  gboolean     building;
+  int          fd;
+  guint32     *offsets;
+  guint        line_count;
+  gint64       mtime;
+  gint64       size;
+  gint64       checked_at;
+  guint        draw;
+  GList       *link;
+} LineIndex;
+
+typedef struct
+{
+  gchar       *file_path;
+  guint        generation;
+  int          fd;
+  GArray      *offsets;
+  gint64       mtime;
+  gint64       size;
+} Build;
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint navigation_snippets_signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (NavigationSnippets, navigation_snippets, G_TYPE_OBJECT)
+
+static void
+navigation_snippets_class_init (NavigationSnippetsClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  navigation_snippets_signals[CHANGED] =
+    g_signal_new ("changed", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationSnippetsClass, changed), 
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+  gobject_class->finalize = (GObjectFinalizeFunc) navigation_snippets_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationSnippetsPrivate));
+}
+
+static void
+clear_index (LineIndex *index)
+{
+  if (index->fd >= 0)
+    close (index->fd);
+  g_free (index->offsets);
+  index->fd = -1;
+  index->offsets = NULL;
+  index->line_count = 0;
+}
+
+static void
+line_index_free (LineIndex *index)
+{
+  clear_index (index);
+  g_free (index->file_path);
+  g_slice_free (LineIndex, index);
+}
+
+static void
+build_free (Build *build)
+{
+  if (build->fd >= 0)
+    close (build->fd);
+  if (build->offsets != NULL)
+    g_array_free (build->offsets, TRUE);
+  g_free (build->file_path);
+  g_slice_free (Build, build);
+}
+
+static void
+navigation_snippets_init (NavigationSnippets *snippets)
+{
+  NavigationSnippetsPrivate *priv;
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+  priv->indexes = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, 
+                                         (GDestroyNotify) line_index_free);
+  priv->recent = g_queue_new ();
+  priv->draw = 0;
+  priv->next_generation = 0;
+  priv->snippet = g_string_new (NULL);
+  priv->cancellable = g_cancellable_new ();
+}
+
+static void
+navigation_snippets_finalize (NavigationSnippets *snippets)
+{
+  NavigationSnippetsPrivate *priv;
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+  
+  /* the builds still running see this and leave the indexes alone */
+  g_cancellable_cancel (priv->cancellable);
+  g_object_unref (priv->cancellable);
+  
+  g_queue_free (priv->recent);
+  g_hash_table_destroy (priv->indexes);
+  g_string_free (priv->snippet, TRUE);
+  
+  G_OBJECT_CLASS (navigation_snippets_parent_class)->finalize (G_OBJECT (snippets));
+}
+
+NavigationSnippets*
+navigation_snippets_new (void)
+{
+  return NAVIGATION_SNIPPETS (g_object_new (navigation_snippets_get_type (), NULL));
+}
+
+static void
+build_thread (GTask        *task,
+              gpointer      source_object,
+              Build        *build,
+              GCancellable *cancellable)
+{
+  gchar buffer[READ_SIZE];
+  struct stat st;
+  guint32 offset;
+  guint32 read_so_far = 0;
+  gssize length;
+  int fd;
+
+  fd = g_open (build->file_path, O_RDONLY, 0);
+  if (fd < 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  if (fstat (fd, &st) != 0)
+    {
+      close (fd);
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  build->mtime = st.st_mtime;
+  build->size = st.st_size;
+
+  if (!S_ISREG (st.st_mode) || st.st_size > MAX_FILE_SIZE)
+    {
+      close (fd);
+      g_task_return_boolean (task, TRUE);
+      return;
+    }
+
+  build->offsets = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  offset = 0;
+  g_array_append_val (build->offsets, offset);
+
+  while (read_so_far < MAX_FILE_SIZE && 
+         (length = read (fd, buffer, MIN (sizeof (buffer), MAX_FILE_SIZE - read_so_far))) > 0)
+    {
+      const gchar *line;
+      const gchar *end;
+
+      if (g_task_return_error_if_cancelled (task))
+        {
+          close (fd);
+          return;
+        }
+
+      end = buffer + length;
+      for (line = buffer; line < end; line++)
+        {
+          line = memchr (line, '\n', end - line);
+          if (line == NULL)
+            break;
+          offset = read_so_far + (line + 1 - buffer);
+          g_array_append_val (build->offsets, offset);
+        }
+
+      read_so_far += length;
+    }
+
+  /* a newline at the very end does not start another line */
+  if (build->offsets->len > 1 && offset == read_so_far)
+    g_array_set_size (build->offsets, build->offsets->len - 1);
+
+  build->size = read_so_far;
+  build->fd = fd;
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+build_done (GObject            *source_object,
+            GAsyncResult       *result,
+            NavigationSnippets *snippets)
+{
+  NavigationSnippetsPrivate *priv;
+  LineIndex *index;
+  Build *build;
+
+  /* the snippets are already gone */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    return;
+
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+
+  build = g_task_get_task_data (G_TASK (result));
+
+  /* the index was dropped, or rebuilt again, while this one ran */
+  index = g_hash_table_lookup (priv->indexes, build->file_path);
+  if (index == NULL || index->generation != build->generation)
+    return;
+
+  index->building = FALSE;
+  index->mtime = build->mtime;
+  index->size = build->size;
+  index->checked_at = g_get_monotonic_time ();
+
+  if (build->offsets != NULL)
+    {
+      index->fd = build->fd;
+      build->fd = -1;
+      index->line_count = build->offsets->len;
+      index->offsets = (guint32 *) g_array_free (build->offsets, FALSE);
+      build->offsets = NULL;
+    }
+
+  g_signal_emit (snippets, navigation_snippets_signals[CHANGED], 0);
+}
+
+static void
+start_build (NavigationSnippets *snippets,
+             LineIndex          *index)
+{
+  NavigationSnippetsPrivate *priv;
+  Build *build;
+  GTask *task;
+
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+
+  clear_index (index);
+  index->building = TRUE;
+  index->generation = priv->next_generation++;
+
+  build = g_slice_new0 (Build);
+  build->file_path = g_strdup (index->file_path);
+  build->generation = index->generation;
+  build->fd = -1;
+  build->mtime = -1;
+  build->size = -1;
+
+  task = g_task_new (NULL, priv->cancellable, 
+                     (GAsyncReadyCallback) build_done, snippets);
+  g_task_set_task_data (task, build, (GDestroyNotify) build_free);
+  g_task_run_in_thread (task, (GTaskThreadFunc) build_thread);
+  g_object_unref (task);
+}
+
+static LineIndex*
+lookup_index (NavigationSnippets *snippets,
+              const gchar        *file_path)
+{
+  NavigationSnippetsPrivate *priv;
+  LineIndex *index;
+
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+
+  index = g_hash_table_lookup (priv->indexes, file_path);
+
+  if (index != NULL)
+    {
+      g_queue_unlink (priv->recent, index->link);
+      g_queue_push_head_link (priv->recent, index->link);
+      index->draw = priv->draw;
+      return index;
+    }
+
+  index = g_slice_new0 (LineIndex);
+  index->file_path = g_strdup (file_path);
+  index->fd = -1;
+  index->draw = priv->draw;
+  g_hash_table_insert (priv->indexes, index->file_path, index);
+  g_queue_push_head (priv->recent, index);
+  index->link = priv->recent->head;
+
+  /* what the current draw has used is at the front, and stays */
+  while (priv->recent->length > MAX_INDEXES)
+    {
+      LineIndex *oldest = g_queue_peek_tail (priv->recent);
+      if (oldest->draw == priv->draw)
+        break;
+      g_queue_pop_tail (priv->recent);
+      g_hash_table_remove (priv->indexes, oldest->file_path);
+    }
+
+  start_build (snippets, index);
+
+  return index;
+}
+
+/*
+ * Rebuilds the index if the file is no longer the one it was built from,
+ * going by its mtime and size.
+ */
+static void
+check_index (NavigationSnippets *snippets,
+             LineIndex          *index)
+{
+  GStatBuf st;
+  gint64 mtime = -1;
+  gint64 size = -1;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+  if (now - index->checked_at < CHECK_INTERVAL)
+    return;
+
+  index->checked_at = now;
+
+  if (g_stat (index->file_path, &st) == 0)
+    {
+      mtime = st.st_mtime;
+      size = st.st_size;
+    }
+
+  if (mtime != index->mtime || size != index->size)
+    start_build (snippets, index);
+}
+
+/*
+ * Marks the start of a draw. The indexes asked for from here until the next
+ * one are kept however many files that comes to.
+ */
+void
+navigation_snippets_start_draw (NavigationSnippets *snippets)
+{
+  NAVIGATION_SNIPPETS_GET_PRIVATE (snippets)->draw++;
+}
+
+/*
+ * The line, from 1, with its indentation taken off and cut down to a sane
+ * length. NULL when the file is still being indexed or cannot be read. The
+ * string belongs to snippets and is only good until the next call.
+ */
+const gchar*
+navigation_snippets_get (NavigationSnippets *snippets,
+                         const gchar        *file_path,
+                         gint                line_number)
+{
+  NavigationSnippetsPrivate *priv;
+  LineIndex *index;
+  gchar buffer[LINE_READ_SIZE];
+  const gchar *start;
+  const gchar *end;
+  const gchar *valid_end;
+  gint64 line_end;
+  gssize length;
+  guint line;
+
+  priv = NAVIGATION_SNIPPETS_GET_PRIVATE (snippets);
+
+  if (file_path == NULL)
+    return NULL;
+
+  index = lookup_index (snippets, file_path);
+
+  if (!index->building)
+    check_index (snippets, index);
+
+  if (index->building || index->offsets == NULL)
+    return NULL;
+
+  line = MAX (line_number, 1) - 1;
+  if (line >= index->line_count)
+    return NULL;
+
+  if (line + 1 < index->line_count)
+    line_end = index->offsets[line + 1];
+  else
+    line_end = index->size;
+
+  length = pread (index->fd, buffer, 
+                  MIN (sizeof (buffer), (gsize) (line_end - index->offsets[line])), 
+                  index->offsets[line]);
+  if (length < 0)
+    return NULL;
+
+  start = buffer;
+  end = buffer + length;
+
+  while (start < end && g_ascii_isspace (*start))
+    start++;
+  while (end > start && g_ascii_isspace (end[-1]))
+    end--;
+
+  end = MIN (end, start + MAX_SNIPPET_LENGTH);
+
+  /* binary files, and a multibyte character cut in half */
+  g_utf8_validate (start, end - start, &valid_end);
+
+  g_string_truncate (priv->snippet, 0);
+  g_string_append_len (priv->snippet, start, valid_end - start);
+
+  return priv->snippet->str;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_SNIPPETS_H__
+#define __NAVIGATION_SNIPPETS_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_SNIPPETS_TYPE            (navigation_snippets_get_type ())
+#define NAVIGATION_SNIPPETS(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_SNIPPETS_TYPE, NavigationSnippets))
+#define NAVIGATION_SNIPPETS_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_SNIPPETS_TYPE, NavigationSnippetsClass))
+#define IS_NAVIGATION_SNIPPETS(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_SNIPPETS_TYPE))
+#define IS_NAVIGATION_SNIPPETS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_SNIPPETS_TYPE))
+
+typedef struct _NavigationSnippets NavigationSnippets;
+typedef struct _NavigationSnippetsClass NavigationSnippetsClass;
+
+struct _NavigationSnippets
+{
+  GObject parent_instance;
+};
+
+struct _NavigationSnippetsClass
+{
+  GObjectClass parent_class;
+
+  void (*changed) (NavigationSnippets *snippets);
+};
+
+GType navigation_snippets_get_type (void) G_GNUC_CONST;
+
+NavigationSnippets*  navigation_snippets_new         (void);
+
+void                 navigation_snippets_start_draw  (NavigationSnippets *snippets);
+
+const gchar*         navigation_snippets_get         (NavigationSnippets *snippets,
+                                                      const gchar        *file_path,
+                                                      gint                line_number);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_SNIPPETS_H__ */
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include "navigation-stats.h"
+
+/* bucket 0 holds samples of 0 microseconds, bucket i those in [2^(i-1), 2^i)
+   and the last one all the rest, which is anything from about 4 seconds up */
+#define BUCKETS 24
+#define BAR_WIDTH 40
+
+typedef struct
+{
+  guint64 counts[BUCKETS];
+  guint64 count;
+  gint64  total;
+  gint64  max;
+} Histogram;
+
+struct _NavigationStats
+{
+  Histogram histograms[NAVIGATION_STAT_COUNT];
+};
+
+static const gchar *stat_names[NAVIGATION_STAT_COUNT] = 
+{
+  "path-navigated",
+  "previous",
+  "next",
+  "select-position",
+  "pane-refresh",
+  "select-document"
+};
+
+NavigationStats*
+navigation_stats_new (void)
+{
+  return g_new0 (NavigationStats, 1);
+}
+
+void
+navigation_stats_free (NavigationStats *stats)
+{
+  g_free (stats);
+}
+
+static guint
+get_bucket (gint64 elapsed)
+{
+  guint bucket = 0;
+
+  while (elapsed > 0 && bucket < BUCKETS - 1)
+    {
+      elapsed >>= 1;
+      bucket++;
+    }
+
+  return bucket;
+}
+
+/*
+ * Records the time since started, a g_get_monotonic_time taken when the
+ * action began.
+ */
+void
+navigation_stats_record (NavigationStats *stats,
+                         NavigationStat   stat,
+                         gint64           started)
+{
+  Histogram *histogram;
+  gint64 elapsed;
+
+  elapsed = MAX (0, g_get_monotonic_time () - started);
+
+  histogram = &stats->histograms[stat];
+  histogram->counts[get_bucket (elapsed)]++;
+  histogram->count++;
+  histogram->total += elapsed;
+  histogram->max = MAX (histogram->max, elapsed);
+}
+
+void
+navigation_stats_reset (NavigationStats *stats)
+{
+  memset (stats->histograms, 0, sizeof (stats->histograms));
+}
+
+static void
+append_duration (GString *string,
+                 gint64   microseconds)
+{
+  if (microseconds < 1000)
+    g_string_append_printf (string, "%" G_GINT64_FORMAT " us", microseconds);
+  else if (microseconds < G_USEC_PER_SEC)
+    g_string_append_printf (string, "%.1f ms", microseconds / 1000.0);
+  else
+    g_string_append_printf (string, "%.1f s", microseconds / (gdouble) G_USEC_PER_SEC);
+}
+
+static void
+append_histogram (GString     *string,
+                  const gchar *name,
+                  Histogram   *histogram)
+{
+  guint64 largest = 0;
+  guint bucket;
+
+  g_string_append_printf (string, "%s: %" G_GUINT64_FORMAT " calls", name, histogram->count);
+
+  if (histogram->count == 0)
+    {
+      g_string_append (string, "\n\n");
+      return;
+    }
+
+  g_string_append (string, ", mean ");
+  append_duration (string, histogram->total / (gint64) histogram->count);
+  g_string_append (string, ", max ");
+  append_duration (string, histogram->max);
+  g_string_append_c (string, '\n');
+
+  for (bucket = 0; bucket < BUCKETS; bucket++)
+    largest = MAX (largest, histogram->counts[bucket]);
+
+  for (bucket = 0; bucket < BUCKETS; bucket++)
+    {
+      gsize start;
+      guint bar;
+
+      if (histogram->counts[bucket] == 0)
+        continue;
+
+      start = string->len;
+      g_string_append (string, "  < ");
+      if (bucket == BUCKETS - 1)
+        g_string_append (string, "max");
+      else
+        append_duration (string, (gint64) 1 << bucket);
+
+      /* line the counts up whatever the width of the bound */
+      while (string->len - start < 14)
+        g_string_append_c (string, ' ');
+
+      g_string_append_printf (string, "%10" G_GUINT64_FORMAT " ", histogram->counts[bucket]);
+
+      bar = MAX (1, histogram->counts[bucket] * BAR_WIDTH / largest);
+      while (bar-- > 0)
+        g_string_append_c (string, '#');
+      g_string_append_c (string, '\n');
+    }
+
+  g_string_append_c (string, '\n');
+}
+
+gchar*
+navigation_stats_to_string (NavigationStats *stats)
+{
+  GString *string;
+  guint stat;
+
+  string = g_string_new (NULL);
+
+  for (stat = 0; stat < NAVIGATION_STAT_COUNT; stat++)
+    append_histogram (string, stat_names[stat], &stats->histograms[stat]);
+
+  return g_string_free (string, FALSE);
+}
+
+gboolean
+navigation_stats_dump (NavigationStats  *stats,
+                       const gchar      *file_path,
+                       GError          **error)
+{
+  gchar *contents;
+  gboolean result;
+
+  contents = navigation_stats_to_string (stats);
+  result = g_file_set_contents (file_path, contents, -1, error);
+  g_free (contents);
+
+  return result;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_STATS_H__
+#define __NAVIGATION_STATS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Latency histograms for the engine's actions. Each sample lands in the
+ * bucket of its power of two in microseconds, so recording one is a few
+ * integer operations and the histograms never grow.
+ */
+typedef enum
+{
+  NAVIGATION_STAT_PATH_NAVIGATED,
+  NAVIGATION_STAT_PREVIOUS,
+  NAVIGATION_STAT_NEXT,
+  NAVIGATION_STAT_SELECT_POSITION,
+  NAVIGATION_STAT_PANE_REFRESH,
+  NAVIGATION_STAT_SELECT_DOCUMENT,
+  NAVIGATION_STAT_COUNT
+} NavigationStat;
+
+typedef struct _NavigationStats NavigationStats;
+
+NavigationStats*  navigation_stats_new        (void);
+void              navigation_stats_free       (NavigationStats  *stats);
+
+void              navigation_stats_record     (NavigationStats  *stats,
+                                               NavigationStat    stat,
+                                               gint64            started);
+void              navigation_stats_reset      (NavigationStats  *stats);
+
+gchar*            navigation_stats_to_string  (NavigationStats  *stats);
+gboolean          navigation_stats_dump       (NavigationStats  *stats,
+                                               const gchar      *file_path,
+                                               GError          **error);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_STATS_H__ */
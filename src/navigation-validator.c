@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include "navigation-validator.h"
+
+/*
+ * Keeps the missing flag of every path in the pool up to date. Each path is
+ * checked with an asynchronous query when it is interned or when asked to,
+ * and the directories holding the paths are monitored so that files deleted
+ * or moved away later are noticed too. Nothing here blocks the main loop.
+ */
+
+static void navigation_validator_class_init  (NavigationValidatorClass *klass);
+static void navigation_validator_init        (NavigationValidator      *validator);
+static void navigation_validator_finalize    (NavigationValidator      *validator);
+
+static void path_added                       (NavigationPath           *path,
+                                              NavigationValidator      *validator);
+static void path_removed                     (NavigationPath           *path,
+                                              NavigationValidator      *validator);
+static void monitor_changed                  (GFileMonitor             *monitor,
+                                              GFile                    *file,
+                                              GFile                    *other_file,
+                                              GFileMonitorEvent         event,
+                                              NavigationValidator      *validator);
+static void start_queries                    (NavigationValidator      *validator);
+
+#define NAVIGATION_VALIDATOR_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), NAVIGATION_VALIDATOR_TYPE, NavigationValidatorPrivate))
+
+#define MAX_QUERIES 4
+
+typedef struct _NavigationValidatorPrivate NavigationValidatorPrivate;
+
+struct _NavigationValidatorPrivate
+{
+  NavigationPathPool *pool;
+  GHashTable         *directories;
+  GHashTable         *queued;
+  GQueue             *pending;
+  guint               running;
+  GCancellable       *cancellable;
+};
+
+typedef struct
+{
+  GFileMonitor *monitor;
+  gulong        changed_id;
+  guint         count;
+} DirectoryWatch;
+
+typedef struct
+{
+  NavigationValidator *validator;
+  NavigationPath      *path;
+} Query;
+
+enum
+{
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint navigation_validator_signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (NavigationValidator, navigation_validator, G_TYPE_OBJECT)
+
+static void
+navigation_validator_class_init (NavigationValidatorClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  navigation_validator_signals[CHANGED] =
+    g_signal_new ("changed", 
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST | G_SIGNAL_NO_RECURSE | G_SIGNAL_NO_HOOKS,
+                  G_STRUCT_OFFSET (NavigationValidatorClass, changed), 
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__VOID, G_TYPE_NONE, 0);
+
+  gobject_class->finalize = (GObjectFinalizeFunc) navigation_validator_finalize;
+  g_type_class_add_private (klass, sizeof (NavigationValidatorPrivate));
+}
+
+static void
+directory_watch_free (DirectoryWatch *watch)
+{
+  if (watch->monitor != NULL)
+    {
+      g_signal_handler_disconnect (watch->monitor, watch->changed_id);
+      g_file_monitor_cancel (watch->monitor);
+      g_object_unref (watch->monitor);
+    }
+  g_slice_free (DirectoryWatch, watch);
+}
+
+static void
+navigation_validator_init (NavigationValidator *validator)
+{
+  NavigationValidatorPrivate *priv;
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  priv->pool = NULL;
+  priv->directories = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, 
+                                             (GDestroyNotify) directory_watch_free);
+  priv->queued = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->pending = g_queue_new ();
+  priv->running = 0;
+  priv->cancellable = g_cancellable_new ();
+}
+
+static void
+navigation_validator_finalize (NavigationValidator *validator)
+{
+  NavigationValidatorPrivate *priv;
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  navigation_path_pool_set_listener (priv->pool, NULL, NULL, NULL);
+  
+  /* the running queries see the cancellation and let go of their paths */
+  g_cancellable_cancel (priv->cancellable);
+  g_object_unref (priv->cancellable);
+  
+  g_queue_free_full (priv->pending, (GDestroyNotify) navigation_path_unref);
+  g_hash_table_destroy (priv->queued);
+  g_hash_table_destroy (priv->directories);
+  
+  G_OBJECT_CLASS (navigation_validator_parent_class)->finalize (G_OBJECT (validator));
+}
+
+NavigationValidator*
+navigation_validator_new (NavigationPathPool *pool)
+{
+  NavigationValidatorPrivate *priv;
+  NavigationValidator *validator;
+
+  validator = NAVIGATION_VALIDATOR (g_object_new (navigation_validator_get_type (), NULL));
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  priv->pool = pool;
+  navigation_path_pool_set_listener (pool, 
+                                     (NavigationPathFunc) path_added, 
+                                     (NavigationPathFunc) path_removed, 
+                                     validator);
+
+  return validator;
+}
+
+static void
+set_missing (NavigationValidator *validator,
+             NavigationPath      *path,
+             gboolean             missing)
+{
+  if (navigation_path_get_missing (path) == missing)
+    return;
+  
+  navigation_path_set_missing (path, missing);
+  g_signal_emit (validator, navigation_validator_signals[CHANGED], 0);
+}
+
+static void
+query_done (GFile        *file,
+            GAsyncResult *result,
+            Query        *query)
+{
+  NavigationValidatorPrivate *priv;
+  GFileInfo *info;
+  GError *error = NULL;
+  
+  info = g_file_query_info_finish (file, result, &error);
+  
+  /* the validator is already gone */
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_error_free (error);
+      navigation_path_unref (query->path);
+      g_slice_free (Query, query);
+      return;
+    }
+  
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (query->validator);
+  priv->running--;
+  g_hash_table_remove (priv->queued, query->path);
+  
+  if (info != NULL)
+    {
+      set_missing (query->validator, query->path, FALSE);
+      g_object_unref (info);
+    }
+  else
+    {
+      /* anything but a plain not found, say a permission error, leaves the
+         entry alone */
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        set_missing (query->validator, query->path, TRUE);
+      g_error_free (error);
+    }
+  
+  start_queries (query->validator);
+  
+  navigation_path_unref (query->path);
+  g_slice_free (Query, query);
+}
+
+static void
+start_queries (NavigationValidator *validator)
+{
+  NavigationValidatorPrivate *priv;
+  NavigationPath *path;
+  
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  while (priv->running < MAX_QUERIES && 
+         (path = g_queue_pop_head (priv->pending)) != NULL)
+    {
+      GFile *file;
+      Query *query;
+      
+      query = g_slice_new (Query);
+      query->validator = validator;
+      query->path = path;
+      
+      file = g_file_new_for_path (navigation_path_get_file_path (path));
+      g_file_query_info_async (file, G_FILE_ATTRIBUTE_STANDARD_TYPE, 
+                               G_FILE_QUERY_INFO_NONE, G_PRIORITY_LOW, 
+                               priv->cancellable, 
+                               (GAsyncReadyCallback) query_done, query);
+      g_object_unref (file);
+      
+      priv->running++;
+    }
+}
+
+/*
+ * Queues a query on whether the file behind path still exists. A restored
+ * history can hold thousands of files, so only a few are queried at once.
+ */
+void
+navigation_validator_check (NavigationValidator *validator,
+                            NavigationPath      *path)
+{
+  NavigationValidatorPrivate *priv;
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  if (g_hash_table_contains (priv->queued, path))
+    return;
+  
+  g_hash_table_add (priv->queued, path);
+  g_queue_push_tail (priv->pending, navigation_path_ref (path));
+  
+  start_queries (validator);
+}
+
+static void
+path_added (NavigationPath      *path,
+            NavigationValidator *validator)
+{
+  NavigationValidatorPrivate *priv;
+  DirectoryWatch *watch;
+  gchar *directory;
+  
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  directory = g_path_get_dirname (navigation_path_get_file_path (path));
+  
+  watch = g_hash_table_lookup (priv->directories, directory);
+  if (watch == NULL)
+    {
+      GFile *file;
+      GError *error = NULL;
+      
+      watch = g_slice_new0 (DirectoryWatch);
+      
+      file = g_file_new_for_path (directory);
+      watch->monitor = g_file_monitor_directory (file, G_FILE_MONITOR_SEND_MOVED, 
+                                                 NULL, &error);
+      g_object_unref (file);
+      
+      if (watch->monitor != NULL)
+        {
+          watch->changed_id = g_signal_connect (G_OBJECT (watch->monitor), "changed", 
+                                                G_CALLBACK (monitor_changed), validator);
+        }
+      else
+        {
+          g_debug ("navigation: unable to monitor %s: %s", directory, error->message);
+          g_error_free (error);
+        }
+      
+      g_hash_table_insert (priv->directories, directory, watch);
+    }
+  else
+    {
+      g_free (directory);
+    }
+  
+  watch->count++;
+  
+  navigation_validator_check (validator, path);
+}
+
+static void
+path_removed (NavigationPath      *path,
+              NavigationValidator *validator)
+{
+  NavigationValidatorPrivate *priv;
+  DirectoryWatch *watch;
+  gchar *directory;
+  
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  directory = g_path_get_dirname (navigation_path_get_file_path (path));
+  
+  watch = g_hash_table_lookup (priv->directories, directory);
+  if (watch != NULL && --watch->count == 0)
+    g_hash_table_remove (priv->directories, directory);
+  
+  g_free (directory);
+}
+
+static void
+mark_file (NavigationValidator *validator,
+           GFile               *file,
+           gboolean             missing)
+{
+  NavigationValidatorPrivate *priv;
+  NavigationPath *path;
+  gchar *file_path;
+  
+  priv = NAVIGATION_VALIDATOR_GET_PRIVATE (validator);
+  
+  file_path = g_file_get_path (file);
+  path = navigation_path_pool_lookup (priv->pool, file_path);
+  
+  if (path != NULL)
+    set_missing (validator, path, missing);
+  
+  g_free (file_path);
+}
+
+static void
+monitor_changed (GFileMonitor        *monitor,
+                 GFile               *file,
+                 GFile               *other_file,
+                 GFileMonitorEvent    event,
+                 NavigationValidator *validator)
+{
+  switch (event)
+    {
+    case G_FILE_MONITOR_EVENT_DELETED:
+      mark_file (validator, file, TRUE);
+      break;
+    case G_FILE_MONITOR_EVENT_MOVED:
+      mark_file (validator, file, TRUE);
+      if (other_file != NULL)
+        mark_file (validator, other_file, FALSE);
+      break;
+    case G_FILE_MONITOR_EVENT_CREATED:
+      mark_file (validator, file, FALSE);
+      break;
+    default:
+      break;
+    }
+}
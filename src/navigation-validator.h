@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_VALIDATOR_H__
+#define __NAVIGATION_VALIDATOR_H__
+
+#include <gio/gio.h>
+#include "navigation-path.h"
+
+G_BEGIN_DECLS
+
+#define NAVIGATION_VALIDATOR_TYPE            (navigation_validator_get_type ())
+#define NAVIGATION_VALIDATOR(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NAVIGATION_VALIDATOR_TYPE, NavigationValidator))
+#define NAVIGATION_VALIDATOR_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NAVIGATION_VALIDATOR_TYPE, NavigationValidatorClass))
+#define IS_NAVIGATION_VALIDATOR(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NAVIGATION_VALIDATOR_TYPE))
+#define IS_NAVIGATION_VALIDATOR_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NAVIGATION_VALIDATOR_TYPE))
+
+typedef struct _NavigationValidator NavigationValidator;
+typedef struct _NavigationValidatorClass NavigationValidatorClass;
+
+struct _NavigationValidator
+{
+  GObject parent_instance;
+};
+
+struct _NavigationValidatorClass
+{
+  GObjectClass parent_class;
+
+  void (*changed) (NavigationValidator *validator);
+};
+
+GType navigation_validator_get_type (void) G_GNUC_CONST;
+
+NavigationValidator*  navigation_validator_new    (NavigationPathPool  *pool);
+
+void                  navigation_validator_check  (NavigationValidator *validator,
+                                                   NavigationPath      *path);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_VALIDATOR_H__ */
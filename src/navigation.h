@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2010 - Jeff Johnston
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef __NAVIGATION_H__
+#define __NAVIGATION_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * The part of the navigation plugin other plugins can call, installed for
+ * them to build against. CodeSlayer loads each plugin into its own module,
+ * so look the functions up by name with g_module_symbol on the navigation
+ * plugin's module. navigation_get_engine returns a reference on the engine,
+ * or NULL while the plugin is not active, and can be called from any
+ * thread. Hand the reference back with navigation_engine_unref, which is
+ * also safe from any thread; the engine outlives deactivation until then.
+ */
+typedef struct _NavigationEngine NavigationEngine;
+
+NavigationEngine*  navigation_get_engine    (void);
+
+NavigationEngine*  navigation_engine_ref    (NavigationEngine *engine);
+void               navigation_engine_unref  (NavigationEngine *engine);
+
+void               navigation_engine_push   (NavigationEngine *engine,
+                                             const gchar      *from_file_path,
+                                             gint              from_line_number,
+                                             const gchar      *to_file_path,
+                                             gint              to_line_number);
+
+/*
+ * A read only copy of the trail. A snapshot never changes once made and is
+ * shared by everyone who asks until the history or one of its lines next
+ * changes, at which point the engine moves to a new epoch and a new
+ * snapshot. Get one on the main thread; it can then be read and released
+ * on any thread. The file paths handed to the iterator belong to the
+ * snapshot and live as long as it.
+ */
+typedef struct _NavigationSnapshot NavigationSnapshot;
+
+typedef gboolean (*NavigationSnapshotFunc) (const gchar *file_path,
+                                            gint         line_number,
+                                            gint64       timestamp,
+                                            gpointer     user_data);
+
+NavigationSnapshot*  navigation_engine_get_snapshot    (NavigationEngine       *engine);
+
+NavigationSnapshot*  navigation_snapshot_ref           (NavigationSnapshot     *snapshot);
+void                 navigation_snapshot_unref         (NavigationSnapshot     *snapshot);
+
+guint64              navigation_snapshot_get_epoch     (NavigationSnapshot     *snapshot);
+guint                navigation_snapshot_get_length    (NavigationSnapshot     *snapshot);
+gint                 navigation_snapshot_get_position  (NavigationSnapshot     *snapshot);
+void                 navigation_snapshot_foreach       (NavigationSnapshot     *snapshot,
+                                                        NavigationSnapshotFunc  func,
+                                                        gpointer                user_data);
+
+G_END_DECLS
+
+#endif /* __NAVIGATION_H__ */